@@ -9,8 +9,17 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "shader.h"
+#include "shaderCompiler.h"
 #include "camera.h"
 #include "cylinder.h"
+#include "lathe.h"
+#include "meshBufferArena.h"
+#include "vertexFetchBenchmark.h"
+#include "primitiveBenchmark.h"
+#include "threadPool.h"
+#include "textureLoader.h"
+#include "textureCache.h"
+#include "materialAtlas.h"
 
 #include <iostream>
 
@@ -20,12 +29,45 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
 void ProcessMouseScroll(float yoffset);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
-unsigned int loadTexture(const char* path);
+
+// material of a draw: a diffuse/specular texture pair (loaded up front or on demand), one packed texture (loaded
+// on demand), or a layer of the material atlas
+struct SceneMaterial
+{
+    unsigned int diffuseMap = 0;
+    unsigned int specularMap = 0;
+    TextureLoader* textureLoader = nullptr;
+    TextureCache* textureCache = nullptr;
+    TextureHandle diffuseHandle;
+    TextureHandle specularHandle;
+    int atlasLayer = 0;
+};
+void bindMaterial(const Shader& shader, const SceneMaterial& material);
 
 // settings
 const unsigned int SCR_WIDTH = 1600;
 const unsigned int SCR_HEIGHT = 1400;
 
+// materials are layers of one pair of 512x512 RGB(A)8 texture arrays, so draws don't rebind textures, but every image
+// is decoded and resized at startup (false loads every material as 2D textures, cooked, streamed and shared)
+const bool USE_MATERIAL_ATLAS = false;
+// specular intensity is packed into alpha of the diffuse maps, one texture, one bind and one texel fetch per material
+// (the atlas and textures loaded on demand, which use "<diffuse>.packed.ctex" from TextureCooker --pack-specular)
+const bool PACK_SPECULAR_INTO_ALPHA = true;
+// textures outside the atlas are streamed in while rendering, at most this many bytes per frame
+const size_t TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024;
+// textures outside the atlas load the first time they are drawn, least recently used ones are evicted above the budget
+const bool LOAD_TEXTURES_ON_DEMAND = true;
+// textures loaded up front keep separate specular maps
+const bool IS_SPECULAR_PACKED = PACK_SPECULAR_INTO_ALPHA && (USE_MATERIAL_ATLAS || LOAD_TEXTURES_ON_DEMAND);
+const size_t TEXTURE_VRAM_BUDGET = 256 * 1024 * 1024;
+// resolution textures are loaded at, lower qualities decode JPEGs at reduced size (for low-spec machines)
+const TextureQuality TEXTURE_QUALITY = TextureQuality::Full;
+// times vertex fetch of planar and interleaved vertex layouts once at startup and prints the results
+const bool RUN_VERTEX_FETCH_BENCHMARK = false;
+// times generation of the procedural primitives (up to millions of vertices) once at startup and prints the results
+const bool RUN_PRIMITIVE_BENCHMARK = false;
+
 // Ortho default is false
 bool ortho = false;
 
@@ -88,10 +130,24 @@ int main()
     // -----------------------------
     glEnable(GL_DEPTH_TEST);
 
-    // build and compile our shader zprogram
-    // ------------------------------------
-    Shader lightingShader("shaderfiles/6.multiple_lights.vs", "shaderfiles/6.multiple_lights.fs");
-    Shader lightCubeShader("shaderfiles/6.light_cube.vs", "shaderfiles/6.light_cube.fs");
+    // submit our shader programs, they compile while the rest of the scene loads
+    // (warm runs load linked programs from the binary cache in "shadercache")
+    // -------------------------------------------------------------------------
+    const double shaderStartTime = glfwGetTime();
+    ShaderCompiler shaderCompiler((GLADloadproc)glfwGetProcAddress);
+    std::string materialDefines;
+    if (USE_MATERIAL_ATLAS) {
+        materialDefines += "#define MATERIAL_ATLAS\n";
+    }
+    if (IS_SPECULAR_PACKED) {
+        materialDefines += "#define PACKED_SPECULAR\n";
+    }
+    const auto fallbackProgram = shaderCompiler.submit("shaderfiles/fallback.vs", "shaderfiles/fallback.fs", nullptr, materialDefines);
+    const auto lightingProgram = shaderCompiler.submit("shaderfiles/6.multiple_lights.vs", "shaderfiles/6.multiple_lights.fs", nullptr, materialDefines);
+    const auto lightCubeProgram = shaderCompiler.submit("shaderfiles/6.light_cube.vs", "shaderfiles/6.light_cube.fs");
+    // the tiny fallback program is drawn with until the others are ready, so it's needed right away
+    shaderCompiler.waitFor(fallbackProgram);
+    std::cout << "Shader submission took " << (glfwGetTime() - shaderStartTime) * 1000.0 << " ms" << std::endl;
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -219,8 +275,12 @@ int main()
     glEnableVertexAttribArray(2);
 
 
+    // Round objects share buffers and one VAO (interleaved vertices, drawn with base vertex offsets)
+    MeshBufferArena meshBuffers;
+
     // Cylinder
-    static_meshes_3D::Cylinder cylinder(0.25, 30, 1.0, true, true, true);
+    static_meshes_3D::Cylinder cylinder(0.25, 30, 1.0, true, true, true, static_meshes_3D::VertexLayout::Interleaved,
+        static_meshes_3D::VertexFormat::Float, &meshBuffers);
     unsigned int cylinderVAO, cylinderVBO;
 
     glGenVertexArrays(1, &cylinderVAO);
@@ -228,96 +288,69 @@ int main()
     glGenBuffers(1, &cylinderVBO);
     glBindBuffer(GL_ARRAY_BUFFER, cylinderVBO);
 
-    // load textures (we now use a utility function to keep the code more organized)
+    // load textures (images are decoded in parallel, geometry is set up meanwhile)
     // -----------------------------------------------------------------------------
-    unsigned int marbleDiffuseMap = loadTexture("marble.gif");
-    unsigned int marbleSpecularMap = loadTexture("marble-specmap.jpg");
-    unsigned int pinkMarbleDiffuseMap = loadTexture("pinkMarble.jpg");
-    unsigned int pinkMarbleSpecularMap = loadTexture("pinkMarble-specmap.jpg");
-    unsigned int woodDiffuseMap = loadTexture("wood.jpg");
-    unsigned int woodSpecularMap = loadTexture("wood-specmap.jpg");
-    unsigned int whiteWoodDiffuseMap = loadTexture("white-wood.jpg");
-    unsigned int whiteWoodSpecularMap = loadTexture("white-wood-specmap.jpg");
-    unsigned int metalDiffuseMap = loadTexture("metal.jpg");
-    unsigned int metalSpecularMap = loadTexture("metal-specmap.jpg");
-    unsigned int waxDiffuseMap = loadTexture("wax.jpg");
-    unsigned int waxSpecularMap = loadTexture("wax-specmap.jpg");
-    unsigned int perfumeDiffuseMap = loadTexture("perfume.jpg");
-    unsigned int perfumeSpecularMap = loadTexture("perfume-specmap.jpg");
-    unsigned int perfumeCapDiffuseMap = loadTexture("perfume-cap.jpg");
-    unsigned int perfumeCapSpecularMap = loadTexture("perfume-cap-specmap.jpg");
-    unsigned int perfumeFrontDiffuseMap = loadTexture("perfume-front.jpg");
-    unsigned int perfumeFrontSpecularMap = loadTexture("perfume-front-specmap.jpg");
-    unsigned int greyDiffuseMap = loadTexture("glass.png");
-    unsigned int greySpecularMap = loadTexture("glass-specmap.png");
-    
-    // My own try on making a cylinder
-    float cylinderAngleVertices[] = {
-        // Vertex Positions              // Normal vectors      // Texture coords 
-         0.0f,      0.0f,   0.0f,        0.0f, -1.0f,  0.0f,    0.0f, 0.0f,     // 0 Left point base
-         0.97815f,  0.0f,  -0.20791f,    0.0f, -1.0f,  0.0f,    0.9f, 0.2f,     // 1 Depth point base
-         1.0f,      0.0f,   0.0f,        0.0f, -1.0f,  0.0f,    1.0f, 0.0f,     // 2 Right point base
-
-         1.0f,      0.0f,   0.0f,        0.20791f, 0.0f,  -0.02185f,    0.0f, 0.0f,     // 3 Side Face left bottom
-         0.97815f,  0.0f,  -0.20791f,    0.20791f, 0.0f,  -0.02185f,    1.0f, 0.0f,     // 4 Side Face right bottom
-         1.0f,      1.0f,   0.0f,        0.20791f, 0.0f,  -0.02185f,    0.0f, 1.0f,     // 5 Side Face left top
-         1.0f,      1.0f,   0.0f,        0.20791f, 0.0f,  -0.02185f,    0.0f, 1.0f,     // 6 Side Face left top
-         0.97815f,  1.0f,  -0.20791f,    0.20791f, 0.0f,  -0.02185f,    1.0f, 1.0f,     // 7 Side Face right top
-         0.97815f,  0.0f,  -0.20791f,    0.20791f, 0.0f,  -0.02185f,    1.0f, 0.0f,     // 8 Side Face right bottom
-
-         0.0f,      1.0f,   0.0f,        0.0f, 1.0f,  0.0f,    0.0f, 0.0f,     // 9 Left point top
-         0.97815f,  1.0f,  -0.20791f,    0.0f, 1.0f,  0.0f,    0.9f, 0.2f,     // 10 Depth point top
-         1.0f,      1.0f,   0.0f,        0.0f, 1.0f,  0.0f,    1.0f, 0.0f,     // 11 Right point top
-    };
-    unsigned int cylinderAngleVBO, cylinderAngleVAO;
-    glGenVertexArrays(1, &cylinderAngleVAO);
-    glGenBuffers(1, &cylinderAngleVBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cylinderAngleVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cylinderAngleVertices), cylinderAngleVertices, GL_STATIC_DRAW);
-
-    glBindVertexArray(cylinderAngleVAO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    // My own try on making a glass
-    float glassAngleVertices[] = {
-        // Vertex Positions              // Normal vectors      // Texture coords 
-         0.0f,      0.0f,   0.0f,        0.0f, -1.0f,  0.0f,    0.0f, 0.0f,     // 0 Left point base
-         0.97815f,  0.0f,  -0.20791f,    0.0f, -1.0f,  0.0f,    0.9f, 0.2f,     // 1 Depth point base
-         1.0f,      0.0f,   0.0f,        0.0f, -1.0f,  0.0f,    1.0f, 0.0f,     // 2 Right point base
-
-         1.0f,      0.0f,   0.0f,        0.20791f, 0.0f,  -0.02185f,    0.0f, 0.0f,     // 3 Side Face left bottom
-         0.97815f,  0.0f,  -0.20791f,    0.20791f, 0.0f,  -0.02185f,    1.0f, 0.0f,     // 4 Side Face right bottom
-         1.0f,      1.0f,   0.0f,        0.20791f, 0.0f,  -0.02185f,    0.0f, 1.0f,     // 5 Side Face left top
-         1.0f,      1.0f,   0.0f,        0.20791f, 0.0f,  -0.02185f,    0.0f, 1.0f,     // 6 Side Face left top
-         0.97815f,  1.0f,  -0.20791f,    0.20791f, 0.0f,  -0.02185f,    1.0f, 1.0f,     // 7 Side Face right top
-         0.97815f,  0.0f,  -0.20791f,    0.20791f, 0.0f,  -0.02185f,    1.0f, 0.0f,     // 8 Side Face right bottom
+    setTextureQuality(TEXTURE_QUALITY);
+    ThreadPool threadPool;
+    setDecodeThreadPool(&threadPool);
+    TextureLoader textureLoader(threadPool);
+    TextureCache textureCache(threadPool, TEXTURE_VRAM_BUDGET);
+    MaterialAtlas materialAtlas(512, 512, IS_SPECULAR_PACKED);
+    auto loadMaterial = [&](const char* diffusePath, const char* specularPath)
+    {
+        SceneMaterial material;
+        if (USE_MATERIAL_ATLAS) {
+            material.atlasLayer = materialAtlas.addMaterial(diffusePath, specularPath);
+        }
+        else if (LOAD_TEXTURES_ON_DEMAND && IS_SPECULAR_PACKED)
+        {
+            material.textureCache = &textureCache;
+            material.diffuseHandle = textureCache.getPackedHandle(diffusePath, specularPath);
+        }
+        else if (LOAD_TEXTURES_ON_DEMAND)
+        {
+            material.textureCache = &textureCache;
+            material.diffuseHandle = textureCache.getHandle(diffusePath);
+            material.specularHandle = textureCache.getHandle(specularPath);
+        }
+        else
+        {
+            material.textureLoader = &textureLoader;
+            material.diffuseMap = textureLoader.request(diffusePath);
+            material.specularMap = textureLoader.request(specularPath);
+        }
+        return material;
     };
-    unsigned int glassAngleVBO, glassAngleVAO;
-    glGenVertexArrays(1, &glassAngleVAO);
-    glGenBuffers(1, &glassAngleVBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, glassAngleVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glassAngleVertices), glassAngleVertices, GL_STATIC_DRAW);
-
-    glBindVertexArray(glassAngleVAO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    SceneMaterial marbleMaterial = loadMaterial("marble.gif", "marble-specmap.jpg");
+    SceneMaterial pinkMarbleMaterial = loadMaterial("pinkMarble.jpg", "pinkMarble-specmap.jpg");
+    SceneMaterial woodMaterial = loadMaterial("wood.jpg", "wood-specmap.jpg");
+    SceneMaterial whiteWoodMaterial = loadMaterial("white-wood.jpg", "white-wood-specmap.jpg");
+    SceneMaterial metalMaterial = loadMaterial("metal.jpg", "metal-specmap.jpg");
+    SceneMaterial waxMaterial = loadMaterial("wax.jpg", "wax-specmap.jpg");
+    SceneMaterial perfumeMaterial = loadMaterial("perfume.jpg", "perfume-specmap.jpg");
+    SceneMaterial perfumeCapMaterial = loadMaterial("perfume-cap.jpg", "perfume-cap-specmap.jpg");
+    SceneMaterial perfumeFrontMaterial = loadMaterial("perfume-front.jpg", "perfume-front-specmap.jpg");
+    SceneMaterial greyMaterial = loadMaterial("glass.png", "glass-specmap.png");
+    
+    // Round objects: unit radius, from height 0 to 1, scaled in place (the glass has no top)
+    static_meshes_3D::Lathe closedCylinder({ glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f), glm::vec2(0.0f, 1.0f) }, 30,
+        45.0f, true, true, true, static_meshes_3D::VertexLayout::Interleaved, static_meshes_3D::VertexFormat::Float, &meshBuffers);
+    static_meshes_3D::Lathe openCylinder({ glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f) }, 30,
+        45.0f, true, true, true, static_meshes_3D::VertexLayout::Interleaved, static_meshes_3D::VertexFormat::Float, &meshBuffers);
+
+    // the atlas is built before the first frame, separate textures stream in during the first frames
+    if (USE_MATERIAL_ATLAS) {
+        materialAtlas.build(threadPool);
+    }
 
-    // shader configuration
-    // --------------------
-    lightingShader.use();
-    lightingShader.setInt("material.diffuse", 0);
-    lightingShader.setInt("material.specular", 1);
+    if (RUN_VERTEX_FETCH_BENCHMARK)
+    {
+        Shader vertexFetchShader("shaderfiles/vertex_fetch.vs", "shaderfiles/vertex_fetch.fs");
+        benchmarkVertexFetch(vertexFetchShader.ID);
+    }
+    if (RUN_PRIMITIVE_BENCHMARK) {
+        benchmarkPrimitiveGeneration();
+    }
 
     // render loop
     // -----------
@@ -333,6 +366,21 @@ int main()
         // -----
         processInput(window);
 
+        // stream in decoded textures, a few megabytes per frame
+        // ------------------------------------------------------
+        if (!USE_MATERIAL_ATLAS && LOAD_TEXTURES_ON_DEMAND) {
+            textureCache.update(TEXTURE_UPLOAD_BUDGET);
+        }
+        else if (!USE_MATERIAL_ATLAS) {
+            textureLoader.streamDecoded(TEXTURE_UPLOAD_BUDGET);
+        }
+
+        // pick up shader programs that finished compiling, draw with the fallback until then
+        // ---------------------------------------------------------------------------------
+        shaderCompiler.poll();
+        Shader lightingShader(shaderCompiler.getProgramIDOrFallback(lightingProgram, fallbackProgram));
+        Shader lightCubeShader(shaderCompiler.getProgramIDOrFallback(lightCubeProgram, fallbackProgram));
+
         // render
         // ------
         glClearColor(0.6f, 0.6f, 0.6f, 1.0f);
@@ -340,6 +388,11 @@ int main()
 
         // be sure to activate shader when setting uniforms/drawing objects
         lightingShader.use();
+        lightingShader.setInt("material.diffuse", 0);
+        lightingShader.setInt("material.specular", 1);
+        if (USE_MATERIAL_ATLAS) {
+            materialAtlas.bind(0, 1);
+        }
         lightingShader.setVec3("viewPos", camera.Position);
 
         // directional light
@@ -402,10 +455,7 @@ int main()
         lightingShader.setFloat("material.shininess", 100.0f);
 
         // render boxes
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, woodDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, woodSpecularMap);
+        bindMaterial(lightingShader, woodMaterial);
         glBindVertexArray(cubeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, -0.15f, 0.0f));
@@ -416,10 +466,7 @@ int main()
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
         // render chest legs
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, metalDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, metalSpecularMap);
+        bindMaterial(lightingShader, metalMaterial);
         glBindVertexArray(chestLegsVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-0.53f, -0.5f, -0.03f));
@@ -429,10 +476,7 @@ int main()
         lightingShader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, metalDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, metalSpecularMap);
+        bindMaterial(lightingShader, metalMaterial);
         glBindVertexArray(chestLegsVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.29f, -0.5f, 0.38f));
@@ -442,10 +486,7 @@ int main()
         lightingShader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, metalDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, metalSpecularMap);
+        bindMaterial(lightingShader, metalMaterial);
         glBindVertexArray(chestLegsVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.53f, -0.5f, 0.03f));
@@ -455,10 +496,7 @@ int main()
         lightingShader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, metalDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, metalSpecularMap);
+        bindMaterial(lightingShader, metalMaterial);
         glBindVertexArray(chestLegsVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-0.29f, -0.5f, -0.38f));
@@ -469,10 +507,7 @@ int main()
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
         // Metal decor
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, metalDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, metalSpecularMap);
+        bindMaterial(lightingShader, metalMaterial);
         glBindVertexArray(cubeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, 0.15f, 0.0f));
@@ -483,10 +518,7 @@ int main()
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
         // Cylinder top
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, woodDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, woodSpecularMap);
+        bindMaterial(lightingShader, woodMaterial);
         glBindVertexArray(cylinderVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, 0.2f, 0.0f));
@@ -501,10 +533,7 @@ int main()
         cylinder.render();
 
         // Pink marble box
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, pinkMarbleDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, pinkMarbleSpecularMap);
+        bindMaterial(lightingShader, pinkMarbleMaterial);
         glBindVertexArray(cubeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-0.25f, -0.43f, 0.8f));
@@ -514,10 +543,7 @@ int main()
         lightingShader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, pinkMarbleDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, pinkMarbleSpecularMap);
+        bindMaterial(lightingShader, pinkMarbleMaterial);
         glBindVertexArray(cubeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-0.25f, -0.37f, 0.8f));
@@ -528,10 +554,7 @@ int main()
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
         // render perfume
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, perfumeDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, perfumeSpecularMap);
+        bindMaterial(lightingShader, perfumeMaterial);
         glBindVertexArray(cubeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-1.0f, -0.30f, 0.0f));
@@ -541,10 +564,7 @@ int main()
         lightingShader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, perfumeFrontDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, perfumeFrontSpecularMap);
+        bindMaterial(lightingShader, perfumeFrontMaterial);
         glBindVertexArray(planeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-0.93f, -0.30f, 0.105f));
@@ -556,29 +576,15 @@ int main()
         lightingShader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, perfumeCapDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, perfumeCapSpecularMap);
-        glBindVertexArray(cylinderAngleVAO);
-        for (unsigned int i = 0; i < 30; i++)
-        {
-            // calculate the model matrix for each object and pass it to shader before drawing
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(-1.0f, -0.05f, 0.0f));
-            float angle = 12.0f * i;
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.08f, 0.15f, 0.08f));
-            lightingShader.setMat4("model", model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-        }
+        bindMaterial(lightingShader, perfumeCapMaterial);
+        model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(-1.0f, -0.05f, 0.0f));
+        model = glm::scale(model, glm::vec3(0.08f, 0.15f, 0.08f));
+        lightingShader.setMat4("model", model);
+        closedCylinder.render();
 
         // render white base
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, whiteWoodDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, whiteWoodSpecularMap);
+        bindMaterial(lightingShader, whiteWoodMaterial);
         glBindVertexArray(cubeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-0.5f, -1.5f, 0.0f));
@@ -589,10 +595,7 @@ int main()
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
         // render plane
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, marbleDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, marbleSpecularMap);
+        bindMaterial(lightingShader, marbleMaterial);
         glBindVertexArray(planeVAO);
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, -2.0f, 0.0f));
@@ -603,59 +606,27 @@ int main()
         // ====== My cylinder ============
 
         // render candle
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, waxDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, waxSpecularMap);
-        glBindVertexArray(cylinderAngleVAO);
-        for (unsigned int i = 0; i < 30; i++)
-        {
-            // calculate the model matrix for each object and pass it to shader before drawing
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(-1.0f, -0.5f, 1.0f));
-            float angle = 12.0f * i;
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.04f, 0.25f, 0.04f));
-            lightingShader.setMat4("model", model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-        }
+        bindMaterial(lightingShader, waxMaterial);
+        model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(-1.0f, -0.5f, 1.0f));
+        model = glm::scale(model, glm::vec3(0.04f, 0.25f, 0.04f));
+        lightingShader.setMat4("model", model);
+        closedCylinder.render();
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, greyDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, greySpecularMap);
-        glBindVertexArray(cylinderAngleVAO);
-        for (unsigned int i = 0; i < 30; i++)
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(-1.0f, -0.25f, 1.0f));
-            float angle = 12.0f * i;
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.005f, 0.05f, 0.005f));
-            lightingShader.setMat4("model", model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-        }
+        bindMaterial(lightingShader, greyMaterial);
+        model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(-1.0f, -0.25f, 1.0f));
+        model = glm::scale(model, glm::vec3(0.005f, 0.05f, 0.005f));
+        lightingShader.setMat4("model", model);
+        closedCylinder.render();
 
         // render glass
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, greyDiffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, greySpecularMap);
-        glBindVertexArray(glassAngleVAO);
-        for (unsigned int i = 0; i < 30; i++)
-        {
-            // calculate the model matrix for each object and pass it to shader before drawing
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(-1.0f, -0.5f, 1.0f));
-            float angle = 12.0f * i;
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.09f, 0.30f, 0.09f));
-            lightingShader.setMat4("model", model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-        }
+        bindMaterial(lightingShader, greyMaterial);
+        model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(-1.0f, -0.5f, 1.0f));
+        model = glm::scale(model, glm::vec3(0.09f, 0.30f, 0.09f));
+        lightingShader.setMat4("model", model);
+        openCylinder.render();
 
         // ==== LIGHTS ====
         // 
@@ -736,6 +707,33 @@ void processInput(GLFWwindow* window)
         }
 }
 
+// binds textures of a material for the next draw (with the atlas, only its layer is selected)
+void bindMaterial(const Shader& shader, const SceneMaterial& material)
+{
+    if (USE_MATERIAL_ATLAS) {
+        shader.setInt("material.layer", material.atlasLayer);
+        return;
+    }
+
+    // textures loaded on demand start loading here, the first time they are drawn
+    // files with the contents of another one are drawn with its texture
+    auto diffuseMap = material.textureLoader != nullptr ? material.textureLoader->getTexture(material.diffuseMap) : material.diffuseMap;
+    auto specularMap = material.textureLoader != nullptr ? material.textureLoader->getTexture(material.specularMap) : material.specularMap;
+    if (material.textureCache != nullptr)
+    {
+        diffuseMap = material.textureCache->use(material.diffuseHandle);
+        specularMap = material.textureCache->use(material.specularHandle);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, diffuseMap);
+    // packed materials are one texture, specular intensity is its alpha
+    if (!IS_SPECULAR_PACKED)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, specularMap);
+    }
+}
+
 // Key callback to handle key "P" to change to Ortho
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
@@ -793,43 +791,4 @@ void ProcessMouseScroll(float yoffset)
         camera.MovementSpeed = 1.0f;
     if (camera.MovementSpeed > 50.0f)
         camera.MovementSpeed = 50.0f;
-}
-
-// utility function for loading a 2D texture from file
-// ---------------------------------------------------
-unsigned int loadTexture(char const* path)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
 }
\ No newline at end of file
@@ -0,0 +1,451 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCK_COMPRESSION_SSE2
+#include <emmintrin.h>
+#endif
+
+// Project
+#include "blockCompression.h"
+
+namespace block_compression {
+
+namespace {
+
+const int BLOCK_SIZE = 4; // Blocks are 4x4 pixels
+const int BLOCK_PIXELS = BLOCK_SIZE * BLOCK_SIZE;
+
+/**
+ * Block of 16 pixels expanded to RGBA. Single-channel sources are replicated to RGB,
+ * two-channel sources keep their channels in R and G.
+ */
+struct PixelBlock
+{
+    alignas(16) uint8_t rgba[BLOCK_PIXELS * 4];
+};
+
+size_t getBlockBytes(BlockFormat format)
+{
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+void loadBlock(const unsigned char* pixels, int width, int height, int numComponents, int blockX, int blockY, PixelBlock& block)
+{
+    for (auto y = 0; y < BLOCK_SIZE; y++)
+    {
+        // Pad partial blocks by repeating the last row / column
+        const auto sourceY = std::min(blockY * BLOCK_SIZE + y, height - 1);
+        for (auto x = 0; x < BLOCK_SIZE; x++)
+        {
+            const auto sourceX = std::min(blockX * BLOCK_SIZE + x, width - 1);
+            const auto source = pixels + (static_cast<size_t>(sourceY) * width + sourceX) * numComponents;
+            const auto target = block.rgba + (y * BLOCK_SIZE + x) * 4;
+            switch (numComponents)
+            {
+            case 1:
+                target[0] = target[1] = target[2] = source[0];
+                target[3] = 255;
+                break;
+            case 2:
+                target[0] = source[0];
+                target[1] = source[1];
+                target[2] = 0;
+                target[3] = 255;
+                break;
+            case 3:
+                target[0] = source[0];
+                target[1] = source[1];
+                target[2] = source[2];
+                target[3] = 255;
+                break;
+            default:
+                target[0] = source[0];
+                target[1] = source[1];
+                target[2] = source[2];
+                target[3] = source[3];
+                break;
+            }
+        }
+    }
+}
+
+uint16_t packColor565(const int color[3])
+{
+    const auto r = (color[0] * 31 + 127) / 255;
+    const auto g = (color[1] * 63 + 127) / 255;
+    const auto b = (color[2] * 31 + 127) / 255;
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpackColor565(uint16_t packed, int color[3])
+{
+    const auto r = (packed >> 11) & 31;
+    const auto g = (packed >> 5) & 63;
+    const auto b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+void getColorBounds(const PixelBlock& block, int minColor[3], int maxColor[3])
+{
+#ifdef BLOCK_COMPRESSION_SSE2
+    const auto pixels = reinterpret_cast<const __m128i*>(block.rgba);
+    auto minimum = _mm_min_epu8(_mm_min_epu8(pixels[0], pixels[1]), _mm_min_epu8(pixels[2], pixels[3]));
+    auto maximum = _mm_max_epu8(_mm_max_epu8(pixels[0], pixels[1]), _mm_max_epu8(pixels[2], pixels[3]));
+    // Reduce 4 pixels per register to one
+    minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+    maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(1, 0, 3, 2)));
+    minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+    maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(2, 3, 0, 1)));
+    const auto minPacked = static_cast<uint32_t>(_mm_cvtsi128_si32(minimum));
+    const auto maxPacked = static_cast<uint32_t>(_mm_cvtsi128_si32(maximum));
+    for (auto c = 0; c < 3; c++)
+    {
+        minColor[c] = (minPacked >> (c * 8)) & 255;
+        maxColor[c] = (maxPacked >> (c * 8)) & 255;
+    }
+#else
+    for (auto c = 0; c < 3; c++)
+    {
+        minColor[c] = 255;
+        maxColor[c] = 0;
+    }
+    for (auto i = 0; i < BLOCK_PIXELS; i++)
+    {
+        for (auto c = 0; c < 3; c++)
+        {
+            minColor[c] = std::min(minColor[c], static_cast<int>(block.rgba[i * 4 + c]));
+            maxColor[c] = std::max(maxColor[c], static_cast<int>(block.rgba[i * 4 + c]));
+        }
+    }
+#endif
+}
+
+/**
+ * Computes 2-bit BC1 palette positions (0 = first endpoint, 3 = second endpoint) of all pixels
+ * by projecting them onto the line between the endpoints.
+ */
+void getColorPositions(const PixelBlock& block, const int color0[3], const int color1[3], int positions[BLOCK_PIXELS])
+{
+    const int direction[3] = { color1[0] - color0[0], color1[1] - color0[1], color1[2] - color0[2] };
+    const auto lengthSquared = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+
+#ifdef BLOCK_COMPRESSION_SSE2
+    const auto zero = _mm_setzero_si128();
+    const auto origin = _mm_setr_epi16(static_cast<short>(color0[0]), static_cast<short>(color0[1]), static_cast<short>(color0[2]), 0,
+        static_cast<short>(color0[0]), static_cast<short>(color0[1]), static_cast<short>(color0[2]), 0);
+    const auto axis = _mm_setr_epi16(static_cast<short>(direction[0]), static_cast<short>(direction[1]), static_cast<short>(direction[2]), 0,
+        static_cast<short>(direction[0]), static_cast<short>(direction[1]), static_cast<short>(direction[2]), 0);
+    const auto threshold1 = _mm_set1_epi32(lengthSquared);
+    const auto threshold2 = _mm_set1_epi32(lengthSquared * 3);
+    const auto threshold3 = _mm_set1_epi32(lengthSquared * 5);
+    for (auto i = 0; i < BLOCK_PIXELS; i += 4)
+    {
+        const auto pixels = _mm_load_si128(reinterpret_cast<const __m128i*>(block.rgba + i * 4));
+        // Each madd yields (r*dr + g*dg, b*db) pairs for two pixels
+        const auto low = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(pixels, zero), origin), axis);
+        const auto high = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(pixels, zero), origin), axis);
+        const auto even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(2, 0, 2, 0)));
+        const auto odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(3, 1, 3, 1)));
+        const auto dot = _mm_add_epi32(even, odd);
+        // Compare 6 * dot against rounding boundaries at 1/6, 3/6 and 5/6 of the line
+        const auto dot6 = _mm_add_epi32(_mm_slli_epi32(dot, 2), _mm_slli_epi32(dot, 1));
+        const auto position = _mm_sub_epi32(zero, _mm_add_epi32(_mm_add_epi32(_mm_cmpgt_epi32(dot6, threshold1),
+            _mm_cmpgt_epi32(dot6, threshold2)), _mm_cmpgt_epi32(dot6, threshold3)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(positions + i), position);
+    }
+#else
+    for (auto i = 0; i < BLOCK_PIXELS; i++)
+    {
+        const auto pixel = block.rgba + i * 4;
+        const auto dot = (pixel[0] - color0[0]) * direction[0] + (pixel[1] - color0[1]) * direction[1] + (pixel[2] - color0[2]) * direction[2];
+        const auto dot6 = dot * 6;
+        positions[i] = (dot6 > lengthSquared ? 1 : 0) + (dot6 > lengthSquared * 3 ? 1 : 0) + (dot6 > lengthSquared * 5 ? 1 : 0);
+    }
+#endif
+}
+
+/**
+ * Encodes 8-byte BC1 color block (always in 4-color mode, as required by BC3 as well).
+ */
+void encodeColorBlock(const PixelBlock& block, unsigned char* output)
+{
+    int minColor[3], maxColor[3];
+    getColorBounds(block, minColor, maxColor);
+
+    // Inset the bounding box a little, so that endpoints are not wasted on outliers
+    for (auto c = 0; c < 3; c++)
+    {
+        const auto inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] += inset;
+        maxColor[c] -= inset;
+    }
+
+    // Pick the diagonal of the bounding box that follows the colors, using green as the reference axis
+    int center[3];
+    for (auto c = 0; c < 3; c++) {
+        center[c] = (minColor[c] + maxColor[c] + 1) >> 1;
+    }
+    auto covarianceRG = 0;
+    auto covarianceBG = 0;
+    for (auto i = 0; i < BLOCK_PIXELS; i++)
+    {
+        const auto pixel = block.rgba + i * 4;
+        const auto g = pixel[1] - center[1];
+        covarianceRG += (pixel[0] - center[0]) * g;
+        covarianceBG += (pixel[2] - center[2]) * g;
+    }
+    if (covarianceRG < 0) {
+        std::swap(minColor[0], maxColor[0]);
+    }
+    if (covarianceBG < 0) {
+        std::swap(minColor[2], maxColor[2]);
+    }
+
+    auto packed0 = packColor565(maxColor);
+    auto packed1 = packColor565(minColor);
+    if (packed0 < packed1) {
+        std::swap(packed0, packed1);
+    }
+
+    output[0] = static_cast<unsigned char>(packed0 & 255);
+    output[1] = static_cast<unsigned char>(packed0 >> 8);
+    output[2] = static_cast<unsigned char>(packed1 & 255);
+    output[3] = static_cast<unsigned char>(packed1 >> 8);
+
+    uint32_t indices = 0;
+    if (packed0 != packed1)
+    {
+        // Project against the quantized endpoints the GPU will actually interpolate
+        int color0[3], color1[3];
+        unpackColor565(packed0, color0);
+        unpackColor565(packed1, color1);
+
+        int positions[BLOCK_PIXELS];
+        getColorPositions(block, color0, color1, positions);
+
+        // Palette order is color0, color1, 2/3 color0 + 1/3 color1, 1/3 color0 + 2/3 color1
+        static const uint32_t POSITION_TO_INDEX[4] = { 0, 2, 3, 1 };
+        for (auto i = 0; i < BLOCK_PIXELS; i++) {
+            indices |= POSITION_TO_INDEX[positions[i]] << (i * 2);
+        }
+    }
+
+    output[4] = static_cast<unsigned char>(indices & 255);
+    output[5] = static_cast<unsigned char>((indices >> 8) & 255);
+    output[6] = static_cast<unsigned char>((indices >> 16) & 255);
+    output[7] = static_cast<unsigned char>(indices >> 24);
+}
+
+/**
+ * Encodes 8-byte BC4 block of one channel of the block (also used for BC3 alpha and both BC5 channels).
+ */
+void encodeChannelBlock(const PixelBlock& block, int channel, unsigned char* output)
+{
+    alignas(16) uint8_t values[BLOCK_PIXELS];
+    for (auto i = 0; i < BLOCK_PIXELS; i++) {
+        values[i] = block.rgba[i * 4 + channel];
+    }
+
+    int positions[BLOCK_PIXELS];
+    int minValue, maxValue;
+#ifdef BLOCK_COMPRESSION_SSE2
+    const auto zero = _mm_setzero_si128();
+    const auto data = _mm_load_si128(reinterpret_cast<const __m128i*>(values));
+    auto minimum = _mm_min_epu8(data, _mm_srli_si128(data, 8));
+    auto maximum = _mm_max_epu8(data, _mm_srli_si128(data, 8));
+    minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 4));
+    maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 4));
+    minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 2));
+    maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 2));
+    minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 1));
+    maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 1));
+    minValue = _mm_cvtsi128_si32(minimum) & 255;
+    maxValue = _mm_cvtsi128_si32(maximum) & 255;
+
+    // Position along the range in sevenths, rounded: count boundaries at (2k - 1) / 14 that 14 * distance exceeds
+    const auto range = maxValue - minValue;
+    const auto maximumValues = _mm_set1_epi16(static_cast<short>(maxValue));
+    const auto distanceLow = _mm_sub_epi16(maximumValues, _mm_unpacklo_epi8(data, zero));
+    const auto distanceHigh = _mm_sub_epi16(maximumValues, _mm_unpackhi_epi8(data, zero));
+    const auto scaledLow = _mm_sub_epi16(_mm_slli_epi16(distanceLow, 4), _mm_slli_epi16(distanceLow, 1));
+    const auto scaledHigh = _mm_sub_epi16(_mm_slli_epi16(distanceHigh, 4), _mm_slli_epi16(distanceHigh, 1));
+    auto positionLow = zero;
+    auto positionHigh = zero;
+    for (auto k = 1; k <= 7; k++)
+    {
+        const auto threshold = _mm_set1_epi16(static_cast<short>((2 * k - 1) * range));
+        positionLow = _mm_sub_epi16(positionLow, _mm_cmpgt_epi16(scaledLow, threshold));
+        positionHigh = _mm_sub_epi16(positionHigh, _mm_cmpgt_epi16(scaledHigh, threshold));
+    }
+    alignas(16) int16_t positions16[BLOCK_PIXELS];
+    _mm_store_si128(reinterpret_cast<__m128i*>(positions16), positionLow);
+    _mm_store_si128(reinterpret_cast<__m128i*>(positions16 + 8), positionHigh);
+    for (auto i = 0; i < BLOCK_PIXELS; i++) {
+        positions[i] = positions16[i];
+    }
+#else
+    minValue = 255;
+    maxValue = 0;
+    for (auto i = 0; i < BLOCK_PIXELS; i++)
+    {
+        minValue = std::min(minValue, static_cast<int>(values[i]));
+        maxValue = std::max(maxValue, static_cast<int>(values[i]));
+    }
+
+    const auto range = maxValue - minValue;
+    for (auto i = 0; i < BLOCK_PIXELS; i++)
+    {
+        const auto scaledDistance = (maxValue - values[i]) * 14;
+        positions[i] = 0;
+        for (auto k = 1; k <= 7; k++) {
+            positions[i] += scaledDistance > (2 * k - 1) * range ? 1 : 0;
+        }
+    }
+#endif
+
+    // Endpoint 0 > endpoint 1 selects the 8-value palette: value0, value1, then 6 interpolated values from value0 to value1
+    output[0] = static_cast<unsigned char>(maxValue);
+    output[1] = static_cast<unsigned char>(minValue);
+
+    uint64_t indices = 0;
+    if (maxValue != minValue)
+    {
+        static const uint64_t POSITION_TO_INDEX[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+        for (auto i = 0; i < BLOCK_PIXELS; i++) {
+            indices |= POSITION_TO_INDEX[positions[i]] << (i * 3);
+        }
+    }
+
+    for (auto i = 0; i < 6; i++) {
+        output[2 + i] = static_cast<unsigned char>((indices >> (i * 8)) & 255);
+    }
+}
+
+void encodeBlock(BlockFormat format, const PixelBlock& block, unsigned char* output)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        encodeColorBlock(block, output);
+        break;
+    case BlockFormat::BC3:
+        encodeChannelBlock(block, 3, output);
+        encodeColorBlock(block, output + 8);
+        break;
+    case BlockFormat::BC4:
+        encodeChannelBlock(block, 0, output);
+        break;
+    case BlockFormat::BC5:
+        encodeChannelBlock(block, 0, output);
+        encodeChannelBlock(block, 1, output + 8);
+        break;
+    }
+}
+
+} // namespace
+
+BlockFormat chooseBlockFormat(const unsigned char* pixels, int width, int height, int numComponents)
+{
+    if (numComponents == 1) {
+        return BlockFormat::BC4;
+    }
+    if (numComponents == 2) {
+        return BlockFormat::BC5;
+    }
+
+    const auto numPixels = static_cast<size_t>(width) * height;
+    auto isGreyscale = true;
+    auto hasAlpha = false;
+    for (size_t i = 0; i < numPixels; i++)
+    {
+        const auto pixel = pixels + i * numComponents;
+        if (pixel[0] != pixel[1] || pixel[0] != pixel[2]) {
+            isGreyscale = false;
+        }
+        if (numComponents == 4 && pixel[3] != 255) {
+            hasAlpha = true;
+        }
+    }
+
+    if (hasAlpha) {
+        return BlockFormat::BC3;
+    }
+
+    return isGreyscale ? BlockFormat::BC4 : BlockFormat::BC1;
+}
+
+GLenum getInternalFormat(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC4:
+        return GL_COMPRESSED_RED_RGTC1;
+    default:
+        return GL_COMPRESSED_RG_RGTC2;
+    }
+}
+
+int getNumComponents(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        return 3;
+    case BlockFormat::BC3:
+        return 4;
+    case BlockFormat::BC4:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+size_t getCompressedSize(BlockFormat format, int width, int height)
+{
+    const auto blocksX = static_cast<size_t>((std::max(width, 1) + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    const auto blocksY = static_cast<size_t>((std::max(height, 1) + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    return blocksX * blocksY * getBlockBytes(format);
+}
+
+std::vector<unsigned char> compressImage(BlockFormat format, const unsigned char* pixels, int width, int height, int numComponents, ThreadPool* threadPool)
+{
+    std::vector<unsigned char> result(getCompressedSize(format, width, height));
+    const auto blockBytes = getBlockBytes(format);
+    const auto blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const auto blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    // Every row of blocks writes its own part of the output, so rows are independent tasks
+    const auto compressRow = [&](int blockY)
+    {
+        PixelBlock block;
+        auto output = result.data() + static_cast<size_t>(blockY) * blocksX * blockBytes;
+        for (auto blockX = 0; blockX < blocksX; blockX++)
+        {
+            loadBlock(pixels, width, height, numComponents, blockX, blockY, block);
+            encodeBlock(format, block, output);
+            output += blockBytes;
+        }
+    };
+
+    if (threadPool != nullptr && blocksY > 1) {
+        threadPool->parallelFor(blocksY, compressRow);
+    }
+    else
+    {
+        for (auto blockY = 0; blockY < blocksY; blockY++) {
+            compressRow(blockY);
+        }
+    }
+
+    return result;
+}
+
+} // namespace block_compression
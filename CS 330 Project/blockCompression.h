@@ -0,0 +1,68 @@
+#pragma once
+// STL
+#include <vector>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// Project
+#include "threadPool.h"
+
+// S3TC formats come from EXT_texture_compression_s3tc, which the core loader does not cover
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace block_compression {
+
+/**
+ * Supported block-compressed formats. All of them encode 4x4 pixel blocks.
+ */
+enum class BlockFormat
+{
+    BC1, // RGB, 8 bytes per block (4 bits per pixel), used for diffuse maps
+    BC3, // RGBA, 16 bytes per block (BC1 color + BC4 alpha), used for maps with alpha
+    BC4, // Single channel, 8 bytes per block, used for greyscale maps such as specular maps
+    BC5  // Two channels, 16 bytes per block (two BC4 blocks)
+};
+
+/**
+ * Picks block format for an 8-bit image by its contents: BC4 for greyscale images,
+ * BC5 for two-channel images, BC3 for images with non-opaque alpha, BC1 otherwise.
+ */
+BlockFormat chooseBlockFormat(const unsigned char* pixels, int width, int height, int numComponents);
+
+/**
+ * Gets OpenGL internal format of given block format.
+ */
+GLenum getInternalFormat(BlockFormat format);
+
+/**
+ * Gets number of components the texture has after decompression (1 for BC4, 2 for BC5...).
+ */
+int getNumComponents(BlockFormat format);
+
+/**
+ * Gets size of compressed image in bytes (partial blocks at the edges count as whole blocks).
+ */
+size_t getCompressedSize(BlockFormat format, int width, int height);
+
+/**
+ * Compresses 8-bit image. Edge blocks of images with dimensions not divisible by 4
+ * are padded by repeating the last row / column. Uses SSE2 when available.
+ *
+ * @param format         Target block format
+ * @param pixels         Source pixels, tightly packed
+ * @param width          Image width in pixels
+ * @param height         Image height in pixels
+ * @param numComponents  Number of components per source pixel (1-4)
+ * @param threadPool     Pool to spread rows of blocks across, or nullptr to compress on calling thread
+ *
+ * @return Compressed blocks in the layout expected by glCompressedTexImage2D.
+ */
+std::vector<unsigned char> compressImage(BlockFormat format, const unsigned char* pixels, int width, int height, int numComponents, ThreadPool* threadPool = nullptr);
+
+} // namespace block_compression
@@ -0,0 +1,89 @@
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "box.h"
+
+namespace static_meshes_3D {
+
+	namespace {
+
+		const int NUM_FACES = 6;
+
+		/**
+		* Face of a unit box, U x V = normal, so that counter-clockwise cells face outwards.
+		*/
+		struct BoxFace
+		{
+			glm::vec3 normal;
+			glm::vec3 axisU;
+			glm::vec3 axisV;
+		};
+
+		const BoxFace FACES[NUM_FACES] = {
+			{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+			{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+			{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+			{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+			{ glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+			{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) }
+		};
+
+		// Face corners in the order of grid vertices, row by row
+		const glm::vec2 CORNERS[4] = { glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 1.0f), glm::vec2(1.0f, 1.0f) };
+
+	} // namespace
+
+	Box::Box(float width, float height, float depth, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat, MeshBufferArena* bufferArena)
+		: IndexedMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat, bufferArena)
+		, _width(width)
+		, _height(height)
+		, _depth(depth)
+	{
+		initializeData();
+	}
+
+	float Box::getWidth() const
+	{
+		return _width;
+	}
+
+	float Box::getHeight() const
+	{
+		return _height;
+	}
+
+	float Box::getDepth() const
+	{
+		return _depth;
+	}
+
+	void Box::initializeData()
+	{
+		const auto halfSize = glm::vec3(_width, _height, _depth) / 2.0f;
+		generate(NUM_FACES * 4, NUM_FACES * 6, -halfSize, halfSize);
+	}
+
+	void Box::writeVertices(VertexWriter& vertices) const
+	{
+		const auto halfSize = glm::vec3(_width, _height, _depth) / 2.0f;
+		for (const auto& face : FACES)
+		{
+			for (const auto& corner : CORNERS)
+			{
+				const auto unitPosition = face.normal + face.axisU * (corner.x * 2.0f - 1.0f) + face.axisV * (corner.y * 2.0f - 1.0f);
+				vertices.addPosition(unitPosition * halfSize);
+				vertices.addTextureCoordinate(corner);
+			}
+			vertices.addNormal(face.normal, 4);
+		}
+	}
+
+	void Box::writeIndices(IndexWriter& indices) const
+	{
+		for (auto face = 0; face < NUM_FACES; face++) {
+			indices.addGrid(face * 4, 1, 1);
+		}
+	}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,43 @@
+#pragma once
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Axis aligned box static mesh centered at the origin. Every face has its own four vertices,
+	* so that normals stay flat and every face gets the whole texture.
+	*/
+	class Box : public IndexedMesh3D
+	{
+	public:
+		Box(float width, float height, float depth,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
+
+		/**
+		 * Gets box width (along X).
+		 */
+		float getWidth() const;
+
+		/**
+		 * Gets box height (along Y).
+		 */
+		float getHeight() const;
+
+		/**
+		 * Gets box depth (along Z).
+		 */
+		float getDepth() const;
+
+	private:
+		float _width; // Box width (along X)
+		float _height; // Box height (along Y)
+		float _depth; // Box depth (along Z)
+
+		void initializeData() override;
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
+	};
+
+} // namespace static_meshes_3D
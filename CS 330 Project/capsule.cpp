@@ -0,0 +1,82 @@
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "capsule.h"
+#include "sineCosineTable.h"
+
+namespace static_meshes_3D {
+
+	Capsule::Capsule(float radius, float height, int numSlices, int numStacks, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat, MeshBufferArena* bufferArena)
+		: IndexedMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat, bufferArena)
+		, _radius(radius)
+		, _height(height)
+		, _numSlices(numSlices)
+		, _numStacks(numStacks)
+	{
+		initializeData();
+	}
+
+	float Capsule::getRadius() const
+	{
+		return _radius;
+	}
+
+	float Capsule::getHeight() const
+	{
+		return _height;
+	}
+
+	int Capsule::getSlices() const
+	{
+		return _numSlices;
+	}
+
+	int Capsule::getStacks() const
+	{
+		return _numStacks;
+	}
+
+	void Capsule::initializeData()
+	{
+		// Both hemispheres have their own equator ring, the cylinder is the band between them
+		const auto numRings = (_numStacks + 1) * 2;
+		const auto numTriangles = IndexWriter::getNumGridTriangles(_numSlices, numRings - 1, true, true);
+		const auto halfExtent = glm::vec3(_radius, _height / 2.0f + _radius, _radius);
+		generate((_numSlices + 1) * numRings, numTriangles * 3, -halfExtent, halfExtent);
+	}
+
+	void Capsule::writeVertices(VertexWriter& vertices) const
+	{
+		const auto stackAngleStep = glm::half_pi<float>() / float(_numStacks);
+		const auto slices = computeSineCosineTable(_numSlices + 1, 2.0f * glm::pi<float>() / float(_numSlices));
+		const auto latitudes = computeSineCosineTable(_numStacks * 2 + 1, stackAngleStep, -glm::half_pi<float>());
+		const auto outlineLength = glm::pi<float>() * _radius + _height;
+
+		// Rings from the south to the north pole, the equator (latitude index _numStacks) is used by both hemispheres
+		for (auto hemisphere = 0; hemisphere < 2; hemisphere++)
+		{
+			const auto centerY = hemisphere == 0 ? -_height / 2.0f : _height / 2.0f;
+			for (auto stack = 0; stack <= _numStacks; stack++)
+			{
+				const auto latitude = hemisphere * _numStacks + stack;
+				const auto outlinePosition = _radius * stackAngleStep * latitude + hemisphere * _height;
+				const auto v = outlinePosition / outlineLength;
+				for (auto slice = 0; slice <= _numSlices; slice++)
+				{
+					const auto normal = glm::vec3(latitudes.cosines[latitude] * slices.cosines[slice], latitudes.sines[latitude], -latitudes.cosines[latitude] * slices.sines[slice]);
+					vertices.addPosition(normal * _radius + glm::vec3(0.0f, centerY, 0.0f));
+					vertices.addTextureCoordinate(glm::vec2(float(slice) / float(_numSlices), v));
+					vertices.addNormal(normal);
+				}
+			}
+		}
+	}
+
+	void Capsule::writeIndices(IndexWriter& indices) const
+	{
+		indices.addGrid(0, _numSlices, (_numStacks + 1) * 2 - 1, true, true);
+	}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,49 @@
+#pragma once
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Capsule static mesh centered at the origin: a cylinder along Y capped by two hemispheres.
+	* Texture wraps around once (U) and spans the whole outline from pole to pole (V, by arc length).
+	*/
+	class Capsule : public IndexedMesh3D
+	{
+	public:
+		Capsule(float radius, float height, int numSlices, int numStacks,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
+
+		/**
+		 * Gets radius of the capsule (of the cylinder and both hemispheres).
+		 */
+		float getRadius() const;
+
+		/**
+		 * Gets height of the cylindrical part (the whole capsule is height + 2 * radius tall).
+		 */
+		float getHeight() const;
+
+		/**
+		 * Gets number of capsule slices.
+		 */
+		int getSlices() const;
+
+		/**
+		 * Gets number of stacks of each hemisphere.
+		 */
+		int getStacks() const;
+
+	private:
+		float _radius; // Radius of the cylinder and hemispheres
+		float _height; // Height of the cylindrical part
+		int _numSlices; // Number of slices around Y
+		int _numStacks; // Number of stacks per hemisphere
+
+		void initializeData() override;
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
+	};
+
+} // namespace static_meshes_3D
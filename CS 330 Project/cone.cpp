@@ -0,0 +1,98 @@
+// STL
+#include <cmath>
+
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "cone.h"
+#include "sineCosineTable.h"
+
+namespace static_meshes_3D {
+
+	Cone::Cone(float radius, float height, int numSlices, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat, MeshBufferArena* bufferArena)
+		: IndexedMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat, bufferArena)
+		, _radius(radius)
+		, _height(height)
+		, _numSlices(numSlices)
+	{
+		initializeData();
+	}
+
+	float Cone::getRadius() const
+	{
+		return _radius;
+	}
+
+	float Cone::getHeight() const
+	{
+		return _height;
+	}
+
+	int Cone::getSlices() const
+	{
+		return _numSlices;
+	}
+
+	void Cone::initializeData()
+	{
+		// Side rim (with seam), apex per slice, base center and base rim
+		generate((_numSlices + 1) + _numSlices + 1 + _numSlices, _numSlices * 6,
+			glm::vec3(-_radius, -_height / 2.0f, -_radius), glm::vec3(_radius, _height / 2.0f, _radius));
+	}
+
+	void Cone::writeVertices(VertexWriter& vertices) const
+	{
+		const auto sliceAngleStep = 2.0f * glm::pi<float>() / float(_numSlices);
+		const auto rim = computeSineCosineTable(_numSlices + 1, sliceAngleStep);
+		const auto apex = computeSineCosineTable(_numSlices, sliceAngleStep, sliceAngleStep / 2.0f);
+
+		// Side normal tilts up by the slope of the side
+		const auto slantLength = std::sqrt(_height * _height + _radius * _radius);
+		const auto normalHorizontal = _height / slantLength;
+		const auto normalUp = _radius / slantLength;
+
+		for (auto i = 0; i <= _numSlices; i++)
+		{
+			const auto direction = glm::vec3(rim.cosines[i], 0.0f, -rim.sines[i]);
+			vertices.addPosition(direction * _radius + glm::vec3(0.0f, -_height / 2.0f, 0.0f));
+			vertices.addTextureCoordinate(glm::vec2(float(i) / float(_numSlices), 0.0f));
+			vertices.addNormal(direction * normalHorizontal + glm::vec3(0.0f, normalUp, 0.0f));
+		}
+		for (auto i = 0; i < _numSlices; i++)
+		{
+			const auto direction = glm::vec3(apex.cosines[i], 0.0f, -apex.sines[i]);
+			vertices.addPosition(glm::vec3(0.0f, _height / 2.0f, 0.0f));
+			vertices.addTextureCoordinate(glm::vec2((float(i) + 0.5f) / float(_numSlices), 1.0f));
+			vertices.addNormal(direction * normalHorizontal + glm::vec3(0.0f, normalUp, 0.0f));
+		}
+
+		// Base disc, texture mapped like the cylinder covers
+		const glm::vec2 baseCenterTexCoord(0.5f, 0.5f);
+		vertices.addPosition(glm::vec3(0.0f, -_height / 2.0f, 0.0f));
+		vertices.addTextureCoordinate(baseCenterTexCoord);
+		for (auto i = 0; i < _numSlices; i++)
+		{
+			vertices.addPosition(glm::vec3(rim.cosines[i] * _radius, -_height / 2.0f, -rim.sines[i] * _radius));
+			vertices.addTextureCoordinate(glm::vec2(baseCenterTexCoord.x + rim.cosines[i] * 0.5f, baseCenterTexCoord.y + rim.sines[i] * 0.5f));
+		}
+		vertices.addNormal(glm::vec3(0.0f, -1.0f, 0.0f), _numSlices + 1);
+	}
+
+	void Cone::writeIndices(IndexWriter& indices) const
+	{
+		const auto firstApex = _numSlices + 1;
+		for (auto i = 0; i < _numSlices; i++) {
+			indices.addTriangle(i, i + 1, firstApex + i);
+		}
+
+		const auto baseCenter = firstApex + _numSlices;
+		for (auto i = 0; i < _numSlices; i++)
+		{
+			const auto next = (i + 1) % _numSlices;
+			indices.addTriangle(baseCenter, baseCenter + 1 + next, baseCenter + 1 + i);
+		}
+	}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,43 @@
+#pragma once
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Cone static mesh with its base centered at -height / 2 and apex at +height / 2. The side is smooth
+	* shaded, with one apex vertex per slice (normal of the slice's middle), the base is a flat disc.
+	*/
+	class Cone : public IndexedMesh3D
+	{
+	public:
+		Cone(float radius, float height, int numSlices,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
+
+		/**
+		 * Gets radius of the cone base.
+		 */
+		float getRadius() const;
+
+		/**
+		 * Gets cone height.
+		 */
+		float getHeight() const;
+
+		/**
+		 * Gets number of cone slices.
+		 */
+		int getSlices() const;
+
+	private:
+		float _radius; // Radius of the base
+		float _height; // Height from the base to the apex
+		int _numSlices; // Number of slices around Y
+
+		void initializeData() override;
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
+	};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,305 @@
+// STL
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+// Project
+#include "cookedTexture.h"
+#include "blockCompression.h"
+
+namespace {
+
+const uint32_t COOKED_TEXTURE_MAGIC = 0x58455443; // "CTEX"
+const uint32_t COOKED_TEXTURE_VERSION = 1;
+const size_t LEVEL_DATA_ALIGNMENT = 16;
+const uint32_t MAX_MIP_LEVELS = 32; // Enough for any 32-bit texture size, keeps the level table size from overflowing
+const uint32_t MAX_LEVEL_DIMENSION = 65536; // Above any GL_MAX_TEXTURE_SIZE, keeps level sizes from overflowing
+
+/**
+ * File header, followed by numMipLevels level entries and then level data.
+ */
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t numComponents;
+    uint32_t internalFormat;
+    uint32_t format;
+    uint32_t type;
+    uint32_t isCompressed;
+    uint32_t numMipLevels;
+};
+
+struct FileMipLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset; // Offset of level data from the start of the file
+    uint64_t size; // Size of level data in bytes
+};
+
+size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Gets number of bytes OpenGL reads when uploading a level of given size and format
+ * (whole 4x4 blocks for compressed formats), so that short levels are rejected before upload.
+ */
+uint64_t getRequiredLevelSize(const CookedTextureFormat& format, uint32_t width, uint32_t height)
+{
+    if (format.isCompressed)
+    {
+        const uint64_t blockBytes = format.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format.internalFormat == GL_COMPRESSED_RED_RGTC1 ? 8 : 16;
+        return ((static_cast<uint64_t>(width) + 3) / 4) * ((static_cast<uint64_t>(height) + 3) / 4) * blockBytes;
+    }
+
+    const uint64_t bytesPerPixel = format.type == GL_UNSIGNED_SHORT_5_6_5 ? 2 : format.numComponents;
+    return static_cast<uint64_t>(width) * height * bytesPerPixel;
+}
+
+} // namespace
+
+bool CookedTexture::open(const std::string& path)
+{
+    close();
+    if (!_file.open(path)) {
+        return false;
+    }
+
+    const auto fileData = _file.getData();
+    const auto fileSize = _file.getSize();
+    if (fileSize < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+
+    const auto header = reinterpret_cast<const FileHeader*>(fileData);
+    if (header->magic != COOKED_TEXTURE_MAGIC || header->version != COOKED_TEXTURE_VERSION || header->numMipLevels == 0
+        || header->numMipLevels > MAX_MIP_LEVELS || header->numComponents < 1 || header->numComponents > 4
+        || fileSize < sizeof(FileHeader) + header->numMipLevels * sizeof(FileMipLevel))
+    {
+        std::cerr << "File " << path << " is not a valid cooked texture" << std::endl;
+        close();
+        return false;
+    }
+
+    _format.numComponents = header->numComponents;
+    _format.internalFormat = header->internalFormat;
+    _format.format = header->format;
+    _format.type = header->type;
+    _format.isCompressed = header->isCompressed != 0;
+
+    const auto fileLevels = reinterpret_cast<const FileMipLevel*>(fileData + sizeof(FileHeader));
+    for (uint32_t i = 0; i < header->numMipLevels; i++)
+    {
+        const auto& fileLevel = fileLevels[i];
+        if (fileLevel.offset > fileSize || fileLevel.size > fileSize - fileLevel.offset)
+        {
+            std::cerr << "Cooked texture " << path << " is truncated" << std::endl;
+            close();
+            return false;
+        }
+
+        if (fileLevel.width == 0 || fileLevel.height == 0 || fileLevel.width > MAX_LEVEL_DIMENSION || fileLevel.height > MAX_LEVEL_DIMENSION
+            || fileLevel.size < getRequiredLevelSize(_format, fileLevel.width, fileLevel.height))
+        {
+            std::cerr << "Cooked texture " << path << " has mip level " << i << " smaller than its dimensions" << std::endl;
+            close();
+            return false;
+        }
+
+        TextureMipLevel mipLevel;
+        mipLevel.width = fileLevel.width;
+        mipLevel.height = fileLevel.height;
+        mipLevel.data = fileData + fileLevel.offset;
+        mipLevel.size = static_cast<size_t>(fileLevel.size);
+        _mipLevels.push_back(mipLevel);
+    }
+
+    return true;
+}
+
+void CookedTexture::close()
+{
+    _file.close();
+    _mipLevels.clear();
+    _format = CookedTextureFormat();
+}
+
+bool CookedTexture::isOpen() const
+{
+    return !_mipLevels.empty();
+}
+
+int CookedTexture::getWidth() const
+{
+    return isOpen() ? _mipLevels[0].width : 0;
+}
+
+int CookedTexture::getHeight() const
+{
+    return isOpen() ? _mipLevels[0].height : 0;
+}
+
+const CookedTextureFormat& CookedTexture::getFormat() const
+{
+    return _format;
+}
+
+int CookedTexture::getNumMipLevels() const
+{
+    return static_cast<int>(_mipLevels.size());
+}
+
+TextureMipLevel CookedTexture::getMipLevel(int level) const
+{
+    return _mipLevels[level];
+}
+
+size_t CookedTexture::getDataSize() const
+{
+    size_t result = 0;
+    for (const auto& mipLevel : _mipLevels) {
+        result += mipLevel.size;
+    }
+
+    return result;
+}
+
+CookedTextureFormat getUncompressedFormat(int numComponents)
+{
+    CookedTextureFormat result;
+    result.numComponents = numComponents;
+    result.type = GL_UNSIGNED_BYTE;
+    result.isCompressed = false;
+    switch (numComponents)
+    {
+    case 1:
+        result.internalFormat = GL_R8;
+        result.format = GL_RED;
+        break;
+    case 2:
+        result.internalFormat = GL_RG8;
+        result.format = GL_RG;
+        break;
+    case 3:
+        result.internalFormat = GL_RGB8;
+        result.format = GL_RGB;
+        break;
+    default:
+        result.internalFormat = GL_RGBA8;
+        result.format = GL_RGBA;
+        break;
+    }
+
+    return result;
+}
+
+std::string getCookedTexturePath(const std::string& imagePath)
+{
+    return imagePath + ".ctex";
+}
+
+std::string getPackedTexturePath(const std::string& diffusePath)
+{
+    return diffusePath + ".packed.ctex";
+}
+
+std::vector<CookedMipLevelData> generateMipChain(const unsigned char* pixels, int width, int height, int numComponents)
+{
+    std::vector<CookedMipLevelData> result;
+
+    CookedMipLevelData baseLevel;
+    baseLevel.width = width;
+    baseLevel.height = height;
+    baseLevel.data.assign(pixels, pixels + static_cast<size_t>(width) * height * numComponents);
+    result.push_back(std::move(baseLevel));
+
+    while (result.back().width > 1 || result.back().height > 1)
+    {
+        const auto& source = result.back();
+        CookedMipLevelData level;
+        level.width = std::max(1, source.width / 2);
+        level.height = std::max(1, source.height / 2);
+        level.data.resize(static_cast<size_t>(level.width) * level.height * numComponents);
+
+        // Average 2x2 source texels, clamping at the edge for odd (or 1 pixel) dimensions
+        for (auto y = 0; y < level.height; y++)
+        {
+            const auto y0 = std::min(y * 2, source.height - 1);
+            const auto y1 = std::min(y * 2 + 1, source.height - 1);
+            for (auto x = 0; x < level.width; x++)
+            {
+                const auto x0 = std::min(x * 2, source.width - 1);
+                const auto x1 = std::min(x * 2 + 1, source.width - 1);
+                for (auto c = 0; c < numComponents; c++)
+                {
+                    const auto sum = source.data[(static_cast<size_t>(y0) * source.width + x0) * numComponents + c]
+                        + source.data[(static_cast<size_t>(y0) * source.width + x1) * numComponents + c]
+                        + source.data[(static_cast<size_t>(y1) * source.width + x0) * numComponents + c]
+                        + source.data[(static_cast<size_t>(y1) * source.width + x1) * numComponents + c];
+                    level.data[(static_cast<size_t>(y) * level.width + x) * numComponents + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+
+        result.push_back(std::move(level));
+    }
+
+    return result;
+}
+
+bool writeCookedTexture(const std::string& path, const CookedTextureFormat& format, const std::vector<CookedMipLevelData>& mipLevels)
+{
+    if (mipLevels.empty()) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    header.magic = COOKED_TEXTURE_MAGIC;
+    header.version = COOKED_TEXTURE_VERSION;
+    header.width = mipLevels[0].width;
+    header.height = mipLevels[0].height;
+    header.numComponents = format.numComponents;
+    header.internalFormat = format.internalFormat;
+    header.format = format.format;
+    header.type = format.type;
+    header.isCompressed = format.isCompressed ? 1 : 0;
+    header.numMipLevels = static_cast<uint32_t>(mipLevels.size());
+
+    // Level data follows the level table in upload order, each level aligned to 16 bytes
+    std::vector<FileMipLevel> fileLevels(mipLevels.size());
+    auto offset = alignUp(sizeof(FileHeader) + fileLevels.size() * sizeof(FileMipLevel), LEVEL_DATA_ALIGNMENT);
+    for (size_t i = 0; i < mipLevels.size(); i++)
+    {
+        fileLevels[i].width = mipLevels[i].width;
+        fileLevels[i].height = mipLevels[i].height;
+        fileLevels[i].offset = offset;
+        fileLevels[i].size = mipLevels[i].data.size();
+        offset = alignUp(offset + mipLevels[i].data.size(), LEVEL_DATA_ALIGNMENT);
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(fileLevels.data()), fileLevels.size() * sizeof(FileMipLevel));
+    const char padding[LEVEL_DATA_ALIGNMENT] = {};
+    for (size_t i = 0; i < mipLevels.size(); i++)
+    {
+        const auto position = static_cast<size_t>(file.tellp());
+        file.write(padding, fileLevels[i].offset - position);
+        file.write(reinterpret_cast<const char*>(mipLevels[i].data.data()), mipLevels[i].data.size());
+    }
+
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,140 @@
+#pragma once
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+// Project
+#include "mappedFile.h"
+
+/**
+ * Pixel format of a cooked texture, stored as OpenGL enums so that
+ * the loader passes them straight to glTexImage2D / glCompressedTexImage2D.
+ */
+struct CookedTextureFormat
+{
+    int numComponents = 0; // Number of components of the source image (1-4)
+    GLenum internalFormat = 0; // Internal format of the texture (e.g. GL_RGB8)
+    GLenum format = 0; // Pixel transfer format (e.g. GL_RGB), unused for compressed textures
+    GLenum type = 0; // Pixel transfer type (e.g. GL_UNSIGNED_BYTE), unused for compressed textures
+    bool isCompressed = false; // Flag telling, if mip levels hold block-compressed data
+};
+
+/**
+ * One mip level of a texture, either in memory or in a mapped cooked file.
+ */
+struct TextureMipLevel
+{
+    int width = 0; // Level width in pixels
+    int height = 0; // Level height in pixels
+    const unsigned char* data = nullptr; // Level data in upload-ready layout
+    size_t size = 0; // Size of level data in bytes
+};
+
+/**
+ * Mip level owning its data, as produced by the cooker.
+ */
+struct CookedMipLevelData
+{
+    int width = 0; // Level width in pixels
+    int height = 0; // Level height in pixels
+    std::vector<unsigned char> data; // Level data in upload-ready layout
+};
+
+/**
+ * Read access to a cooked texture container (".ctex"). The container is a small header,
+ * a table of mip levels and the level data laid out in upload order (level 0 first), so
+ * the loader maps the file and uploads directly from the mapping, without any decoding
+ * or mipmap generation at runtime.
+ */
+class CookedTexture
+{
+public:
+    /**
+     * Maps cooked texture file and validates its header.
+     *
+     * @return True, if the file is a valid cooked texture.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmaps the file.
+     */
+    void close();
+
+    /**
+     * Checks, if a valid cooked texture is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * Gets texture width (of mip level 0).
+     */
+    int getWidth() const;
+
+    /**
+     * Gets texture height (of mip level 0).
+     */
+    int getHeight() const;
+
+    /**
+     * Gets pixel format of the texture.
+     */
+    const CookedTextureFormat& getFormat() const;
+
+    /**
+     * Gets number of stored mip levels.
+     */
+    int getNumMipLevels() const;
+
+    /**
+     * Gets given mip level, pointing directly into the mapped file.
+     */
+    TextureMipLevel getMipLevel(int level) const;
+
+    /**
+     * Gets total size of all mip levels (in bytes).
+     */
+    size_t getDataSize() const;
+
+private:
+    MappedFile _file; // Mapped cooked texture file
+    CookedTextureFormat _format; // Format read from the header
+    std::vector<TextureMipLevel> _mipLevels; // Mip levels pointing into the mapping
+};
+
+/**
+ * Gets 8-bit uncompressed format for images with given number of components (GL_R8 ... GL_RGBA8).
+ */
+CookedTextureFormat getUncompressedFormat(int numComponents);
+
+/**
+ * Gets path of the cooked container for given source image ("wood.jpg" -> "wood.jpg.ctex").
+ */
+std::string getCookedTexturePath(const std::string& imagePath);
+
+/**
+ * Gets path of the cooked container of a material packed into one texture, the diffuse map with
+ * specular intensity in alpha ("wood.jpg" -> "wood.jpg.packed.ctex").
+ */
+std::string getPackedTexturePath(const std::string& diffusePath);
+
+/**
+ * Generates full mip chain (down to 1x1) of an 8-bit image with a 2x2 box filter.
+ *
+ * @return Mip levels, level 0 being a copy of the source image.
+ */
+std::vector<CookedMipLevelData> generateMipChain(const unsigned char* pixels, int width, int height, int numComponents);
+
+/**
+ * Writes cooked texture container.
+ *
+ * @param path       Output file path
+ * @param format     Pixel format of the mip levels
+ * @param mipLevels  Mip levels, level 0 first
+ *
+ * @return True, if the file has been written successfully.
+ */
+bool writeCookedTexture(const std::string& path, const CookedTextureFormat& format, const std::vector<CookedMipLevelData>& mipLevels);
@@ -1,19 +1,19 @@
 #pragma once
-#include "staticMesh3D.h"
+#include "indexedMesh3D.h"
 
 namespace static_meshes_3D {
 
 	/**
-	* Cylinder static mesh with given radius, number of slices and height.
+	* Cylinder static mesh with given radius, number of slices and height. Side and covers share
+	* their vertices through an index buffer, so the whole cylinder is a single draw call.
 	*/
-	class Cylinder : public StaticMesh3D
+	class Cylinder : public IndexedMesh3D
 	{
 	public:
 		Cylinder(float radius, int numSlices, float height,
-			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true);
-
-		void render() const override;
-		void renderPoints() const override;
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
 
 		/**
 		 * Gets cylinder radius.
@@ -35,11 +35,12 @@ namespace static_meshes_3D {
 		int _numSlices; // Number of cylinder slices
 		float _height; // Height of the cylinder
 
-		int _numVerticesSide; // How many vertices to render side of the cylinder
-		int _numVerticesTopBottom; // How many vertices to render top / bottom of the cylinder
-		int _numVerticesTotal; // Just a sum of both numbers above
+		int _numVerticesSide; // How many vertices the side of the cylinder has
+		int _numVerticesTopBottom; // How many vertices the top / bottom cover has (center and rim)
 
 		void initializeData() override;
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
 	};
 
 } // namespace static_meshes_3D
\ No newline at end of file
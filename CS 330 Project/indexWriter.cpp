@@ -0,0 +1,84 @@
+// STL
+#include <limits>
+
+// Project
+#include "indexWriter.h"
+
+namespace static_meshes_3D {
+
+IndexWriter::IndexWriter(VertexBufferObject& vbo, GLenum indexType, int numIndices)
+    : _indexType(indexType)
+    , _shortIndices(indexType == GL_UNSIGNED_SHORT ? vbo.addSpan<GLushort>(numIndices) : StagingSpan<GLushort>(nullptr, 0))
+    , _intIndices(indexType != GL_UNSIGNED_SHORT ? vbo.addSpan<GLuint>(numIndices) : StagingSpan<GLuint>(nullptr, 0)) {}
+
+IndexWriter::IndexWriter(unsigned char* indexData, GLenum indexType, int numIndices)
+    : _indexType(indexType)
+    , _shortIndices(indexType == GL_UNSIGNED_SHORT ? indexData : nullptr, numIndices)
+    , _intIndices(indexType != GL_UNSIGNED_SHORT ? indexData : nullptr, numIndices) {}
+
+GLenum IndexWriter::getIndexType(int numVertices)
+{
+    return numVertices - 1 <= std::numeric_limits<GLushort>::max() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+size_t IndexWriter::getIndexByteSize(GLenum indexType)
+{
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+void IndexWriter::addTriangle(unsigned int a, unsigned int b, unsigned int c)
+{
+    addIndex(a);
+    addIndex(b);
+    addIndex(c);
+}
+
+void IndexWriter::addGrid(unsigned int firstVertex, int numColumns, int numRows, bool isFirstRowCollapsed, bool isLastRowCollapsed)
+{
+    const auto rowSize = static_cast<unsigned int>(numColumns + 1);
+    for (auto row = 0; row < numRows; row++)
+    {
+        const auto rowStart = firstVertex + row * rowSize;
+        for (auto column = 0; column < numColumns; column++)
+        {
+            // Cell corners counter-clockwise, starting at (U, V) = (0, 0)
+            const auto a = rowStart + column;
+            const auto b = a + 1;
+            const auto c = b + rowSize;
+            const auto d = a + rowSize;
+            if (row > 0 || !isFirstRowCollapsed) {
+                addTriangle(a, b, c);
+            }
+            if (row < numRows - 1 || !isLastRowCollapsed) {
+                addTriangle(a, c, d);
+            }
+        }
+    }
+}
+
+int IndexWriter::getNumGridTriangles(int numColumns, int numRows, bool isFirstRowCollapsed, bool isLastRowCollapsed)
+{
+    auto result = numColumns * numRows * 2;
+    if (isFirstRowCollapsed) {
+        result -= numColumns;
+    }
+    if (isLastRowCollapsed) {
+        result -= numColumns;
+    }
+
+    return result;
+}
+
+void IndexWriter::addIndex(unsigned int index)
+{
+    // Spans ignore indices beyond their end, as well as all indices when there is no data to write to
+    if (_indexType == GL_UNSIGNED_SHORT) {
+        _shortIndices.write(_numWritten, static_cast<GLushort>(index));
+    }
+    else {
+        _intIndices.write(_numWritten, index);
+    }
+    _numWritten++;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,77 @@
+#pragma once
+// STL
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// Project
+#include "vertexBufferObject.h"
+#include "stagingArena.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Writes triangle indices of a mesh straight into the index buffer data, as 16-bit indices
+ * if the mesh has few enough vertices, as 32-bit indices otherwise.
+ */
+class IndexWriter
+{
+public:
+	/**
+	 * Appends space for given number of indices to the VBO data. Nothing else may be added
+	 * to the VBO while the writer is in use.
+	 *
+	 * @param vbo         VBO to write the indices to
+	 * @param indexType   GL_UNSIGNED_SHORT or GL_UNSIGNED_INT (see getIndexType)
+	 * @param numIndices  Number of indices to write
+	 */
+	IndexWriter(VertexBufferObject& vbo, GLenum indexType, int numIndices);
+
+	/**
+	 * Writes indices to given memory (e.g. a mapped range of a shared buffer), with room for numIndices indices.
+	 */
+	IndexWriter(unsigned char* indexData, GLenum indexType, int numIndices);
+
+	/**
+	 * Gets smallest index type able to address given number of vertices.
+	 */
+	static GLenum getIndexType(int numVertices);
+
+	/**
+	 * Gets size of one index of given type in bytes.
+	 */
+	static size_t getIndexByteSize(GLenum indexType);
+
+	/**
+	 * Writes triangle (counter-clockwise front face).
+	 */
+	void addTriangle(unsigned int a, unsigned int b, unsigned int c);
+
+	/**
+	 * Writes two triangles per cell of a grid of vertices stored row by row, numColumns + 1 vertices per row,
+	 * for grids whose U axis runs along the rows and V axis from row to row (U x V being the front side).
+	 * Collapsed rows are poles (all their vertices at one point), cells touching them get one triangle only.
+	 *
+	 * @param firstVertex        Index of the first vertex of the first row
+	 * @param numColumns         Number of cells per row
+	 * @param numRows            Number of cell rows (numRows + 1 vertex rows)
+	 * @param isFirstRowCollapsed  Whether the first vertex row is a pole
+	 * @param isLastRowCollapsed   Whether the last vertex row is a pole
+	 */
+	void addGrid(unsigned int firstVertex, int numColumns, int numRows, bool isFirstRowCollapsed = false, bool isLastRowCollapsed = false);
+
+	/**
+	 * Gets number of triangles addGrid writes for given grid, to size the index buffer up front.
+	 */
+	static int getNumGridTriangles(int numColumns, int numRows, bool isFirstRowCollapsed = false, bool isLastRowCollapsed = false);
+
+private:
+	GLenum _indexType; // Type of written indices
+	StagingSpan<GLushort> _shortIndices; // Index data of 16-bit indices (empty for 32-bit ones)
+	StagingSpan<GLuint> _intIndices; // Index data of 32-bit indices (empty for 16-bit ones)
+	int _numWritten = 0; // Number of indices written so far
+
+	void addIndex(unsigned int index);
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,176 @@
+// Project
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+IndexedMesh3D::IndexedMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat,
+    MeshBufferArena* bufferArena)
+    : StaticMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat)
+    , _bufferArena(bufferArena) {}
+
+IndexedMesh3D::~IndexedMesh3D()
+{
+    // Base class destructor would only call its own deleteMesh
+    deleteMesh();
+}
+
+void IndexedMesh3D::render() const
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    if (_bufferPool != nullptr)
+    {
+        _bufferPool->bindVertexArray();
+        _bufferPool->draw(_poolAllocation);
+        return;
+    }
+
+    glBindVertexArray(_vao);
+    glDrawElements(GL_TRIANGLES, _numIndices, _indexType, nullptr);
+}
+
+void IndexedMesh3D::renderInstanced(int numInstances) const
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    if (_bufferPool != nullptr)
+    {
+        _bufferPool->bindVertexArray();
+        _bufferPool->draw(_poolAllocation, numInstances);
+        return;
+    }
+
+    glBindVertexArray(_vao);
+    glDrawElementsInstanced(GL_TRIANGLES, _numIndices, _indexType, nullptr, numInstances);
+}
+
+void IndexedMesh3D::renderPoints() const
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    // Just render all points as they are stored in the VBO
+    if (_bufferPool != nullptr)
+    {
+        _bufferPool->bindVertexArray();
+        glDrawArrays(GL_POINTS, _bufferPool->getDrawRange(_poolAllocation).baseVertex, _numVertices);
+        return;
+    }
+
+    glBindVertexArray(_vao);
+    glDrawArrays(GL_POINTS, 0, _numVertices);
+}
+
+void IndexedMesh3D::deleteMesh()
+{
+    if (_bufferPool != nullptr)
+    {
+        _bufferPool->free(_poolAllocation);
+        _bufferPool = nullptr;
+        _poolAllocation = -1;
+    }
+
+    StaticMesh3D::deleteMesh();
+}
+
+void IndexedMesh3D::renderBatched() const
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    if (_bufferPool != nullptr) {
+        _bufferPool->draw(_poolAllocation);
+    }
+    else {
+        render();
+    }
+}
+
+MeshBufferPool* IndexedMesh3D::getBufferPool() const
+{
+    return _bufferPool;
+}
+
+int IndexedMesh3D::getNumVertices() const
+{
+    return _numVertices;
+}
+
+int IndexedMesh3D::getNumIndices() const
+{
+    return _numIndices;
+}
+
+GLenum IndexedMesh3D::getIndexType() const
+{
+    return _indexType;
+}
+
+void IndexedMesh3D::generate(int numVertices, int numIndices, const glm::vec3& minimumPosition, const glm::vec3& maximumPosition,
+    const glm::vec2& minimumTextureCoordinate, const glm::vec2& maximumTextureCoordinate)
+{
+    if (_isInitialized) {
+        return;
+    }
+
+    _numVertices = numVertices;
+    _numIndices = numIndices;
+    _indexType = IndexWriter::getIndexType(numVertices);
+    setPositionBounds(minimumPosition, maximumPosition);
+    setTextureCoordinateBounds(minimumTextureCoordinate, maximumTextureCoordinate);
+
+    if (_bufferArena != nullptr && _vertexLayout == VertexLayout::Interleaved)
+    {
+        // Ranges of the shared buffers are written while mapped, just like buffers of its own
+        _bufferPool = &_bufferArena->getPool(getVertexFormatDescription(numVertices), _indexType);
+        _poolAllocation = _bufferPool->allocate(numVertices, numIndices);
+        {
+            VertexWriter vertices(*this, _bufferPool->mapVertices(_poolAllocation), numVertices);
+            writeVertices(vertices);
+        }
+        {
+            IndexWriter indices(_bufferPool->mapIndices(_poolAllocation), _indexType, numIndices);
+            writeIndices(indices);
+        }
+        _bufferPool->unmap();
+
+        _isInitialized = true;
+        return;
+    }
+
+    // Generate VAO and VBO for vertex attributes, vertices are written right into the mapped buffer
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+    _vbo.createVBO();
+    _vbo.mapDataForWriting(GL_ARRAY_BUFFER, static_cast<size_t>(getVertexByteSize()) * numVertices, GL_STATIC_DRAW);
+    {
+        VertexWriter vertices(*this, _vbo, numVertices);
+        writeVertices(vertices);
+    }
+
+    // Finally upload data to the GPU
+    _vbo.bindVBO();
+    _vbo.uploadDataToGPU(GL_STATIC_DRAW);
+    setVertexAttributesPointers(numVertices);
+
+    // Element buffer binding is part of the VAO state
+    _indicesVbo.createVBO();
+    _indicesVbo.mapDataForWriting(GL_ELEMENT_ARRAY_BUFFER, IndexWriter::getIndexByteSize(_indexType) * numIndices, GL_STATIC_DRAW);
+    {
+        IndexWriter indices(_indicesVbo, _indexType, numIndices);
+        writeIndices(indices);
+    }
+
+    _indicesVbo.bindVBO(GL_ELEMENT_ARRAY_BUFFER);
+    _indicesVbo.uploadDataToGPU(GL_STATIC_DRAW);
+
+    _isInitialized = true;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,93 @@
+#pragma once
+// Project
+#include "staticMesh3D.h"
+#include "vertexWriter.h"
+#include "indexWriter.h"
+#include "meshBufferArena.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Static mesh drawn as one indexed triangle list. Derived classes only tell how many vertices and
+ * indices they have and write them, buffers are allocated once up front and written while mapped, so even
+ * meshes with millions of vertices are generated without reallocations or staging copies. Meshes of up to 65536 vertices
+ * get 16-bit indices, larger ones 32-bit indices.
+ *
+ * Meshes given a buffer arena don't get buffers and VAO of their own, they take ranges of the arena's
+ * pool for their vertex format and draw with base vertex offsets. This needs the interleaved layout,
+ * planar meshes keep their own buffers (their attribute offsets depend on the vertex count).
+ */
+class IndexedMesh3D : public StaticMesh3D
+{
+public:
+	~IndexedMesh3D() override;
+
+	void render() const override;
+	void renderInstanced(int numInstances) const override;
+	void renderPoints() const override;
+	void deleteMesh() override;
+
+	/**
+	 * Renders the mesh without binding its VAO, for pooled meshes drawn one after another after binding
+	 * their pool's VAO once (see getBufferPool). Meshes with their own buffers bind their VAO anyway.
+	 */
+	void renderBatched() const;
+
+	/**
+	 * Gets buffer pool the mesh lives in, nullptr if it has buffers of its own.
+	 */
+	MeshBufferPool* getBufferPool() const;
+
+	/**
+	 * Gets number of vertices of the mesh.
+	 */
+	int getNumVertices() const;
+
+	/**
+	 * Gets number of indices of the mesh (three per triangle).
+	 */
+	int getNumIndices() const;
+
+	/**
+	 * Gets type of the indices (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+	 */
+	GLenum getIndexType() const;
+
+protected:
+	IndexedMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat,
+		MeshBufferArena* bufferArena = nullptr);
+
+	/**
+	 * Generates the mesh: creates VAO and buffers for given counts, lets the derived class write
+	 * vertices and indices and uploads them. Derived classes call it from initializeData.
+	 *
+	 * @param numVertices      Number of vertices writeVertices writes
+	 * @param numIndices       Number of indices writeIndices writes
+	 * @param minimumPosition  Minimum corner of the bounding box (quantized positions are relative to it)
+	 * @param maximumPosition  Maximum corner of the bounding box
+	 * @param minimumTextureCoordinate  Minimum of all texture coordinates (quantized ones are relative to it)
+	 * @param maximumTextureCoordinate  Maximum of all texture coordinates
+	 */
+	void generate(int numVertices, int numIndices, const glm::vec3& minimumPosition, const glm::vec3& maximumPosition,
+		const glm::vec2& minimumTextureCoordinate = glm::vec2(0.0f), const glm::vec2& maximumTextureCoordinate = glm::vec2(1.0f));
+
+	/**
+	 * Writes all vertices. Attributes the mesh does not have may be skipped, the writer ignores them anyway.
+	 */
+	virtual void writeVertices(VertexWriter& vertices) const = 0;
+
+	/**
+	 * Writes all triangles.
+	 */
+	virtual void writeIndices(IndexWriter& indices) const = 0;
+
+private:
+	int _numVertices = 0; // Number of vertices in the VBO
+	int _numIndices = 0; // Number of indices in the element buffer
+	GLenum _indexType = GL_UNSIGNED_SHORT; // Type of indices in the element buffer
+	MeshBufferArena* _bufferArena; // Arena to take buffer ranges from, nullptr for buffers of its own
+	MeshBufferPool* _bufferPool = nullptr; // Pool the mesh lives in, if pooled
+	int _poolAllocation = -1; // Ranges of the mesh in the pool
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,154 @@
+// STL
+#include <cmath>
+#include <algorithm>
+
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "lathe.h"
+#include "sineCosineTable.h"
+
+namespace static_meshes_3D {
+
+	Lathe::Lathe(const std::vector<glm::vec2>& profile, int numSlices, float creaseAngleDegrees, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat, MeshBufferArena* bufferArena)
+		: IndexedMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat, bufferArena)
+		, _profile(profile)
+		, _numSlices(numSlices)
+		, _creaseAngle(creaseAngleDegrees)
+	{
+		initializeData();
+	}
+
+	const std::vector<glm::vec2>& Lathe::getProfile() const
+	{
+		return _profile;
+	}
+
+	int Lathe::getSlices() const
+	{
+		return _numSlices;
+	}
+
+	void Lathe::initializeData()
+	{
+		computeRings();
+
+		auto numTriangles = 0;
+		for (const auto ring : _segmentRings) {
+			numTriangles += IndexWriter::getNumGridTriangles(_numSlices, 1, _rings[ring].point.x == 0.0f, _rings[ring + 1].point.x == 0.0f);
+		}
+
+		auto maximumRadius = 0.0f;
+		auto minimumHeight = _rings.empty() ? 0.0f : _rings.front().point.y;
+		auto maximumHeight = minimumHeight;
+		for (const auto& ring : _rings)
+		{
+			maximumRadius = std::max(maximumRadius, ring.point.x);
+			minimumHeight = std::min(minimumHeight, ring.point.y);
+			maximumHeight = std::max(maximumHeight, ring.point.y);
+		}
+
+		// Every ring repeats its first vertex for the texture seam, pole rings too
+		generate(int(_rings.size()) * (_numSlices + 1), numTriangles * 3,
+			glm::vec3(-maximumRadius, minimumHeight, -maximumRadius), glm::vec3(maximumRadius, maximumHeight, maximumRadius));
+	}
+
+	void Lathe::computeRings()
+	{
+		_rings.clear();
+		_segmentRings.clear();
+
+		// Repeated points would make segments without direction
+		std::vector<glm::vec2> points;
+		for (const auto& point : _profile)
+		{
+			if (points.empty() || point != points.back()) {
+				points.push_back(point);
+			}
+		}
+		if (points.size() < 2) {
+			return;
+		}
+
+		// Segment normals point to the right of the profile direction
+		std::vector<glm::vec2> segmentNormals;
+		std::vector<float> arcLengths(1, 0.0f);
+		for (size_t i = 0; i + 1 < points.size(); i++)
+		{
+			const auto direction = points[i + 1] - points[i];
+			const auto length = glm::length(direction);
+			segmentNormals.push_back(glm::vec2(direction.y, -direction.x) / length);
+			arcLengths.push_back(arcLengths.back() + length);
+		}
+
+		const auto minimumSmoothCosine = std::cos(glm::radians(_creaseAngle));
+		const auto lastPoint = points.size() - 1;
+		auto segmentStartRing = 0;
+		for (size_t i = 0; i <= lastPoint; i++)
+		{
+			ProfileRing ring;
+			ring.point = points[i];
+			ring.v = arcLengths[i] / arcLengths.back();
+
+			if (i == 0 || i == lastPoint)
+			{
+				// Pole at either end is shaded like the tip of a sphere, straight along Y
+				ring.normal = segmentNormals[i == 0 ? 0 : i - 1];
+				if (ring.point.x == 0.0f && ring.normal.y != 0.0f) {
+					ring.normal = glm::vec2(0.0f, ring.normal.y > 0.0f ? 1.0f : -1.0f);
+				}
+				_rings.push_back(ring);
+			}
+			else
+			{
+				const auto& normalBefore = segmentNormals[i - 1];
+				const auto& normalAfter = segmentNormals[i];
+				if (glm::dot(normalBefore, normalAfter) < minimumSmoothCosine)
+				{
+					// Hard edge, one ring ends the segment before, the next one starts the segment after
+					ring.normal = normalBefore;
+					_rings.push_back(ring);
+					ring.normal = normalAfter;
+					_rings.push_back(ring);
+				}
+				else
+				{
+					ring.normal = glm::normalize(normalBefore + normalAfter);
+					_rings.push_back(ring);
+				}
+			}
+
+			// Segments lying on the axis have no area
+			const auto isOnAxis = i > 0 && points[i - 1].x == 0.0f && points[i].x == 0.0f;
+			if (i > 0 && !isOnAxis) {
+				_segmentRings.push_back(segmentStartRing);
+			}
+			segmentStartRing = int(_rings.size()) - 1;
+		}
+	}
+
+	void Lathe::writeVertices(VertexWriter& vertices) const
+	{
+		const auto slices = computeSineCosineTable(_numSlices + 1, 2.0f * glm::pi<float>() / float(_numSlices));
+		for (const auto& ring : _rings)
+		{
+			for (auto slice = 0; slice <= _numSlices; slice++)
+			{
+				const auto direction = glm::vec3(slices.cosines[slice], 0.0f, -slices.sines[slice]);
+				vertices.addPosition(direction * ring.point.x + glm::vec3(0.0f, ring.point.y, 0.0f));
+				vertices.addTextureCoordinate(glm::vec2(float(slice) / float(_numSlices), ring.v));
+				vertices.addNormal(direction * ring.normal.x + glm::vec3(0.0f, ring.normal.y, 0.0f));
+			}
+		}
+	}
+
+	void Lathe::writeIndices(IndexWriter& indices) const
+	{
+		for (const auto ring : _segmentRings) {
+			indices.addGrid(ring * (_numSlices + 1), _numSlices, 1, _rings[ring].point.x == 0.0f, _rings[ring + 1].point.x == 0.0f);
+		}
+	}
+
+} // namespace static_meshes_3D
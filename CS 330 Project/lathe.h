@@ -0,0 +1,64 @@
+#pragma once
+// STL
+#include <vector>
+
+// Project
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Surface of revolution static mesh: a profile polyline in the (radius, height) plane swept
+	* once around the Y axis. The profile runs with the outside of the surface on its right, e.g.
+	* bottom to top for an outer wall, outwards for a bottom cap and inwards for a top cap. Vertices
+	* are shared between neighboring segments, with smooth normals, except at corners sharper than
+	* the crease angle, which get one ring of vertices per side. Points with radius 0 are poles.
+	* Texture wraps around once (U) and spans the whole profile by arc length (V).
+	*/
+	class Lathe : public IndexedMesh3D
+	{
+	public:
+		/**
+		 * @param profile             Points (radius, height) of the profile, radius at least 0
+		 * @param numSlices           Number of slices around Y
+		 * @param creaseAngleDegrees  Smallest angle between segments that gets a hard edge
+		 */
+		Lathe(const std::vector<glm::vec2>& profile, int numSlices, float creaseAngleDegrees = 45.0f,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
+
+		/**
+		 * Gets profile points (radius, height).
+		 */
+		const std::vector<glm::vec2>& getProfile() const;
+
+		/**
+		 * Gets number of lathe slices.
+		 */
+		int getSlices() const;
+
+	private:
+		/**
+		 * One ring of vertices around Y, a profile point with the normal it is shaded with.
+		 */
+		struct ProfileRing
+		{
+			glm::vec2 point; // Position (radius, height)
+			glm::vec2 normal; // Unit normal (radial, up)
+			float v; // Texture coordinate V, arc length along the profile divided by its total length
+		};
+
+		std::vector<glm::vec2> _profile; // Profile points (radius, height)
+		int _numSlices; // Number of slices around Y
+		float _creaseAngle; // Smallest angle between segments that gets a hard edge (in degrees)
+		std::vector<ProfileRing> _rings; // Rings from the first profile point to the last one
+		std::vector<int> _segmentRings; // First ring of every segment, a segment connects it with the next ring
+
+		void initializeData() override;
+		void computeRings();
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
+	};
+
+} // namespace static_meshes_3D
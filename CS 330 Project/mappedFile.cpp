@@ -0,0 +1,155 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// STL
+#include <cstring>
+
+// Project
+#include "mappedFile.h"
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    const auto fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    const auto mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    const auto data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    _fileHandle = fileHandle;
+    _mappingHandle = mappingHandle;
+    _data = static_cast<const unsigned char*>(data);
+    _size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const auto fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    const auto data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    // Mapping keeps its own reference to the file
+    ::close(fileDescriptor);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    _data = static_cast<const unsigned char*>(data);
+    _size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_mappingHandle);
+    CloseHandle(_fileHandle);
+    _mappingHandle = nullptr;
+    _fileHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+void MappedFile::adviseSequential() const
+{
+#ifndef _WIN32
+    // Windows gets the same hint through FILE_FLAG_SEQUENTIAL_SCAN when opening
+    if (_data != nullptr) {
+        madvise(const_cast<unsigned char*>(_data), _size, MADV_SEQUENTIAL);
+    }
+#endif
+}
+
+bool MappedFile::isOpen() const
+{
+    return _data != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+    return _data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return _size;
+}
+
+uint64_t hashContents(const MappedFile& file)
+{
+    const uint64_t FNV_PRIME = 0x100000001b3ull;
+    const auto data = file.getData();
+    const auto size = file.getSize();
+    uint64_t result = 0xcbf29ce484222325ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        result = (result ^ word) * FNV_PRIME;
+    }
+    for (; i < size; i++) {
+        result = (result ^ data[i]) * FNV_PRIME;
+    }
+
+    return result;
+}
+
+bool hasContents(const std::string& path, const MappedFile& file)
+{
+    MappedFile otherFile;
+    return otherFile.open(path) && otherFile.getSize() == file.getSize() && memcmp(otherFile.getData(), file.getData(), file.getSize()) == 0;
+}
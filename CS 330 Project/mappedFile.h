@@ -0,0 +1,72 @@
+#pragma once
+// STL
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Read-only memory mapping of a whole file (mmap on POSIX, file mapping on Windows).
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Maps file to memory.
+     *
+     * @param path  Path to the file
+     *
+     * @return True, if file has been mapped successfully (empty files can't be mapped).
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmaps file (does nothing if no file is mapped).
+     */
+    void close();
+
+    /**
+     * Hints the OS that the mapping will be read once from start to end,
+     * so that it reads ahead aggressively and drops pages behind.
+     */
+    void adviseSequential() const;
+
+    /**
+     * Checks, if a file is mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * Gets pointer to mapped file contents, or nullptr if nothing is mapped.
+     */
+    const unsigned char* getData() const;
+
+    /**
+     * Gets size of mapped file (in bytes).
+     */
+    size_t getSize() const;
+
+private:
+    const unsigned char* _data = nullptr; // Start of the mapping
+    size_t _size = 0; // Size of the mapping in bytes
+#ifdef _WIN32
+    void* _fileHandle = nullptr; // Handle of the open file
+    void* _mappingHandle = nullptr; // Handle of the file mapping object
+#endif
+};
+
+/**
+ * Hashes contents of a mapped file (FNV-1a over 64-bit words, then the remaining bytes).
+ * Equal hashes only make files candidates for sharing, hasContents confirms them.
+ */
+uint64_t hashContents(const MappedFile& file);
+
+/**
+ * Checks, if file at given path has exactly the contents of a mapped file.
+ */
+bool hasContents(const std::string& path, const MappedFile& file);
@@ -0,0 +1,137 @@
+// STL
+#include <iostream>
+#include <chrono>
+
+// Project
+#include "materialAtlas.h"
+#include "textureLoader.h"
+#include "textureFormat.h"
+
+namespace {
+
+const unsigned char MISSING_IMAGE_VALUE = 128; // Mid-grey layer for images that failed to load
+
+} // namespace
+
+MaterialAtlas::MaterialAtlas(int layerWidth, int layerHeight, bool packSpecular)
+    : _layerWidth(layerWidth)
+    , _layerHeight(layerHeight)
+    , _packSpecular(packSpecular) {}
+
+MaterialAtlas::~MaterialAtlas()
+{
+    if (_diffuseArray != 0) {
+        glDeleteTextures(1, &_diffuseArray);
+    }
+    if (_specularArray != 0) {
+        glDeleteTextures(1, &_specularArray);
+    }
+}
+
+int MaterialAtlas::addMaterial(const std::string& diffusePath, const std::string& specularPath)
+{
+    _diffusePaths.push_back(diffusePath);
+    _specularPaths.push_back(specularPath);
+    return static_cast<int>(_diffusePaths.size()) - 1;
+}
+
+void MaterialAtlas::build(ThreadPool& threadPool)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto numMaterials = getNumMaterials();
+
+    // Diffuse maps go first, specular maps follow in the same order
+    std::vector<std::string> paths(_diffusePaths);
+    paths.insert(paths.end(), _specularPaths.begin(), _specularPaths.end());
+    std::vector<std::vector<unsigned char>> layers(paths.size());
+    const auto layerSize = static_cast<size_t>(_layerWidth) * _layerHeight * 3;
+    const auto quality = getTextureQuality();
+    threadPool.parallelFor(static_cast<int>(paths.size()), [&](int i)
+    {
+        DecodedImage image;
+        image.quality = quality;
+        if (!decodeImage(paths[i], image))
+        {
+            std::cout << "Texture failed to load at path: " << paths[i] << std::endl;
+            layers[i].assign(layerSize, MISSING_IMAGE_VALUE);
+            return;
+        }
+
+        layers[i] = resizeImageToRGB(image.pixels, image.width, image.height, image.numComponents, _layerWidth, _layerHeight);
+        freeDecodedImage(image);
+    });
+
+    std::vector<std::vector<unsigned char>> diffuseLayers(layers.begin(), layers.begin() + numMaterials);
+    const std::vector<std::vector<unsigned char>> specularLayers(layers.begin() + numMaterials, layers.end());
+    if (_packSpecular)
+    {
+        for (auto i = 0; i < numMaterials; i++) {
+            diffuseLayers[i] = packSpecularIntoAlpha(diffuseLayers[i], specularLayers[i]);
+        }
+        _diffuseArray = createArray(diffuseLayers, 4);
+    }
+    else
+    {
+        _diffuseArray = createArray(diffuseLayers, 3);
+        _specularArray = createArray(specularLayers, 3);
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::cout << "Built material atlas with " << numMaterials << " materials (" << _layerWidth << "x" << _layerHeight
+        << " layers" << (_packSpecular ? ", specular packed into alpha" : "") << ") in " << elapsed.count() << " ms" << std::endl;
+}
+
+void MaterialAtlas::bind(GLuint diffuseUnit, GLuint specularUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + diffuseUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _diffuseArray);
+    if (!_packSpecular)
+    {
+        glActiveTexture(GL_TEXTURE0 + specularUnit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _specularArray);
+    }
+}
+
+int MaterialAtlas::getNumMaterials() const
+{
+    return static_cast<int>(_diffusePaths.size());
+}
+
+GLuint MaterialAtlas::getDiffuseArray() const
+{
+    return _diffuseArray;
+}
+
+GLuint MaterialAtlas::getSpecularArray() const
+{
+    return _specularArray;
+}
+
+bool MaterialAtlas::isSpecularPacked() const
+{
+    return _packSpecular;
+}
+
+GLuint MaterialAtlas::createArray(const std::vector<std::vector<unsigned char>>& layers, int numComponents) const
+{
+    const auto internalFormat = numComponents == 4 ? GL_RGBA8 : GL_RGB8;
+    const auto format = numComponents == 4 ? GL_RGBA : GL_RGB;
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, _layerWidth, _layerHeight, static_cast<GLsizei>(layers.size()), 0, format, GL_UNSIGNED_BYTE, nullptr);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t layer = 0; layer < layers.size(); layer++) {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(layer), _layerWidth, _layerHeight, 1, format, GL_UNSIGNED_BYTE, layers[layer].data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return textureID;
+}
@@ -0,0 +1,92 @@
+#pragma once
+// STL
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Project
+#include "threadPool.h"
+
+/**
+ * All materials of a scene in two texture arrays (GL_TEXTURE_2D_ARRAY), one holding
+ * diffuse maps and one holding specular maps. Every material is one layer of both arrays,
+ * so the arrays are bound once and draws only select their material by index (uniform
+ * "material.layer" of shaders compiled with MATERIAL_ATLAS defined). Draws with different
+ * materials no longer need any texture rebinding and can be batched into one call.
+ *
+ * All layers of an array share one size, images of other sizes are resized on import
+ * (images of the layer size are copied as they are).
+ *
+ * Optionally, specular intensity is packed into the alpha channel of the diffuse array
+ * (shaders compiled with PACKED_SPECULAR defined), so one RGBA array holds whole materials.
+ * That saves a texture unit and about a third of the texture memory, and the shader
+ * fetches one texel per fragment instead of two.
+ */
+class MaterialAtlas
+{
+public:
+    /**
+     * @param layerWidth   Width of every layer in pixels
+     * @param layerHeight  Height of every layer in pixels
+     * @param packSpecular Flag telling, if specular intensity is packed into alpha of the diffuse array
+     */
+    MaterialAtlas(int layerWidth = 512, int layerHeight = 512, bool packSpecular = false);
+    ~MaterialAtlas();
+
+    MaterialAtlas(const MaterialAtlas&) = delete;
+    MaterialAtlas& operator=(const MaterialAtlas&) = delete;
+
+    /**
+     * Adds material to the atlas. Images are loaded later, by build().
+     *
+     * @param diffusePath   Path to the diffuse map
+     * @param specularPath  Path to the specular map
+     *
+     * @return Material index, which is also the layer of the material in both arrays.
+     */
+    int addMaterial(const std::string& diffusePath, const std::string& specularPath);
+
+    /**
+     * Decodes and resizes all images in parallel on the thread pool, then uploads them
+     * into the texture arrays and generates mipmaps. Must be called from the GL thread.
+     */
+    void build(ThreadPool& threadPool);
+
+    /**
+     * Binds diffuse array to texture unit GL_TEXTURE0 + diffuseUnit and specular array
+     * to texture unit GL_TEXTURE0 + specularUnit (not bound, if specular is packed).
+     */
+    void bind(GLuint diffuseUnit, GLuint specularUnit) const;
+
+    /**
+     * Gets number of materials in the atlas.
+     */
+    int getNumMaterials() const;
+
+    /**
+     * Gets OpenGL ID of the diffuse texture array (0 before build()).
+     */
+    GLuint getDiffuseArray() const;
+
+    /**
+     * Gets OpenGL ID of the specular texture array (0 before build() or if specular is packed).
+     */
+    GLuint getSpecularArray() const;
+
+    /**
+     * Checks, if specular intensity is packed into alpha of the diffuse array.
+     */
+    bool isSpecularPacked() const;
+
+private:
+    int _layerWidth; // Width of every layer
+    int _layerHeight; // Height of every layer
+    bool _packSpecular; // Flag telling, if specular intensity is packed into the diffuse array
+    std::vector<std::string> _diffusePaths; // Diffuse map of every material, in layer order
+    std::vector<std::string> _specularPaths; // Specular map of every material, in layer order
+    GLuint _diffuseArray = 0; // Texture array holding diffuse maps
+    GLuint _specularArray = 0; // Texture array holding specular maps
+
+    GLuint createArray(const std::vector<std::vector<unsigned char>>& layers, int numComponents) const;
+};
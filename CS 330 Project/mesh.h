@@ -7,9 +7,18 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "shader.h"
+#include "vertexQuantization.h"
+#include "meshOptimizer.h"
+#include "meshBufferArena.h"
 
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <iostream>
+#include <cstring>
+#include <cstddef>
 using namespace std;
 
 struct Vertex {
@@ -25,6 +34,18 @@ struct Vertex {
 	glm::vec3 Bitangent;
 };
 
+// compact vertex of quantized meshes, 20 bytes instead of 56
+struct QuantizedVertex {
+	// position, 16-bit normalized relative to the mesh bounds
+	QuantizedPosition Position;
+	// normal, octahedral in two 16-bit normalized components
+	uint32_t Normal;
+	// texCoords, 16-bit normalized relative to the texture coordinate bounds
+	uint32_t TexCoords;
+	// tangent in GL_INT_2_10_10_10_REV, W is the bitangent sign (bitangent = cross(normal, tangent) * sign)
+	uint32_t Tangent;
+};
+
 struct Texture {
 	unsigned int id;
 	string type;
@@ -38,32 +59,197 @@ public:
 	vector<unsigned int> indices;
 	vector<Texture>      textures;
 	unsigned int VAO;
+	// quantized meshes upload QuantizedVertex and need a shader compiled with QUANTIZED_VERTICES
+	bool quantized;
+	QuantizationRange positionRange;
+	QuantizationRange texCoordRange;
+	// pooled meshes share buffers and VAO with all meshes of their vertex format (nullptr for buffers of their own)
+	MeshBufferPool* bufferPool;
+	int poolAllocation;
+	// counts and bounds of the uploaded mesh, still valid once the CPU-side vertices and indices are released
+	unsigned int numVertices;
+	unsigned int numIndices;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	// bytes of vertices and indices freed after the upload (0 while the mesh keeps them), summed by MeshLoadStatistics
+	size_t releasedHostBytes;
+	// vertex cache behaviour before and after optimizing (equal when the mesh kept its order), see MeshLoadStatistics
+	VertexCacheStatistics cacheBefore;
+	VertexCacheStatistics cacheAfter;
 
-	// constructor
-	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+	// constructor, optimizing reorders triangles and vertices for the GPU (they look the same, but are drawn faster)
+	// meshes given a buffer arena take ranges of its shared buffers, the arena must outlive them
+	// the vectors are taken over rather than copied, pass them with std::move to keep a single copy in RAM
+	// releasing after upload frees the CPU-side vertices and indices, only counts and bounds are kept
+	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, bool quantizeVertices = false, bool optimizeVertexOrder = true,
+		MeshBufferArena* bufferArena = nullptr, bool releaseAfterUpload = false)
+		: vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures))
 	{
-		this->vertices = vertices;
-		this->indices = indices;
-		this->textures = textures;
+		this->quantized = quantizeVertices;
+		this->bufferPool = nullptr;
+		this->poolAllocation = -1;
+		this->releasedHostBytes = 0;
+
+		if (optimizeVertexOrder)
+			optimize();
+		else
+			cacheBefore = cacheAfter = analyzeVertexCache(this->indices, this->vertices.size());
 
 		// now that we have all the required data, set the vertex buffers and its attribute pointers.
-		setupMesh();
+		setupMesh(bufferArena);
+
+		if (releaseAfterUpload)
+			releaseCpuData();
+	}
+
+	// frees the CPU-side vertices and indices, the GPU copy is all Draw needs; returns the bytes reclaimed
+	size_t releaseCpuData()
+	{
+		const size_t bytes = vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(unsigned int);
+		// swapping with empty vectors gives the memory back, clear() would keep the capacity
+		vector<Vertex>().swap(vertices);
+		vector<unsigned int>().swap(indices);
+		releasedHostBytes += bytes;
+		return bytes;
 	}
 
-	// render the mesh
+	// vertex format as the attribute pointers see it, same for all meshes quantized (or not) alike
+	static VertexFormatDescription getVertexFormat(bool quantized)
+	{
+		VertexFormatDescription format;
+		if (quantized)
+		{
+			// same attribute indices as float vertices, the bitangent is derived in the shader
+			const size_t stride = sizeof(QuantizedVertex);
+			format.vertexByteSize = stride;
+			format.attributes = {
+				{ 0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, Position), stride },
+				{ 1, 2, GL_SHORT, GL_TRUE, offsetof(QuantizedVertex, Normal), stride },
+				{ 2, 2, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, TexCoords), stride },
+				{ 3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(QuantizedVertex, Tangent), stride }
+			};
+			return format;
+		}
+
+		const size_t stride = sizeof(Vertex);
+		format.vertexByteSize = stride;
+		format.attributes = {
+			{ 0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Position), stride },
+			{ 1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Normal), stride },
+			{ 2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, TexCoords), stride },
+			{ 3, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Tangent), stride },
+			{ 4, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Bitangent), stride }
+		};
+		return format;
+	}
+
+	// render the mesh, the shader has to be in use
+	// samplers and uniform locations are resolved the first time a shader draws the mesh, later draws only bind textures
 	void Draw(Shader &shader)
 	{
-		// bind appropriate textures
+		const SamplerBinding& binding = getSamplerBinding(shader);
+
+		// bind appropriate textures to the units their samplers were assigned (-1 when the shader doesn't sample them)
+		for (unsigned int i = 0; i < textures.size(); i++)
+		{
+			if (binding.textureUnits[i] < 0)
+				continue;
+			glActiveTexture(GL_TEXTURE0 + binding.textureUnits[i]); // active proper texture unit before binding
+			glBindTexture(GL_TEXTURE_2D, textures[i].id);
+		}
+
+		// ranges the shader maps quantized positions and texture coordinates back to
+		if (quantized)
+		{
+			glUniform3fv(binding.positionOriginLocation, 1, &positionRange.origin[0]);
+			glUniform3fv(binding.positionScaleLocation, 1, &positionRange.scale[0]);
+			glUniform2fv(binding.texCoordOriginLocation, 1, &texCoordRange.origin[0]);
+			glUniform2fv(binding.texCoordScaleLocation, 1, &texCoordRange.scale[0]);
+		}
+
+		// draw mesh
+		if (bufferPool != nullptr)
+		{
+			bufferPool->bindVertexArray();
+			bufferPool->draw(poolAllocation);
+		}
+		else
+		{
+			glBindVertexArray(VAO);
+			glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+		}
+		glBindVertexArray(0);
+
+		// always good practice to set everything back to defaults once configured.
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+private:
+	// render data 
+	unsigned int VBO, EBO;
+
+	// texture units and uniform locations of the mesh resolved against one shader program
+	struct SamplerBinding {
+		unsigned int program;
+		vector<int> textureUnits;
+		int positionOriginLocation;
+		int positionScaleLocation;
+		int texCoordOriginLocation;
+		int texCoordScaleLocation;
+	};
+	// one entry per program that drew the mesh, usually one or two
+	vector<SamplerBinding> samplerBindings;
+
+	// texture unit of every "texture_..." sampler of a program; the units are assigned (glUniform1i) once per program,
+	// in the order the program lists its samplers, so all meshes drawn with it agree on them
+	static const vector<pair<string, int>>& getProgramSamplerUnits(unsigned int program)
+	{
+		static unordered_map<unsigned int, vector<pair<string, int>>> programSamplerUnits;
+		auto it = programSamplerUnits.find(program);
+		if (it != programSamplerUnits.end())
+			return it->second;
+
+		auto& samplerUnits = programSamplerUnits[program];
+		int numUniforms = 0, maxNameLength = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numUniforms);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+		vector<char> name(maxNameLength + 1);
+		for (int i = 0; i < numUniforms; i++)
+		{
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), nullptr, &size, &type, name.data());
+			if (type != GL_SAMPLER_2D || strncmp(name.data(), "texture_", 8) != 0)
+				continue;
+			const int unit = static_cast<int>(samplerUnits.size());
+			glUniform1i(glGetUniformLocation(program, name.data()), unit);
+			samplerUnits.emplace_back(name.data(), unit);
+		}
+		return samplerUnits;
+	}
+
+	// the mesh's binding for the shader, resolving it the first time the shader draws the mesh
+	const SamplerBinding& getSamplerBinding(const Shader& shader)
+	{
+		for (const auto& binding : samplerBindings)
+		{
+			if (binding.program == shader.ID)
+				return binding;
+		}
+
+		const auto& samplerUnits = getProgramSamplerUnits(shader.ID);
+		SamplerBinding binding;
+		binding.program = shader.ID;
+		binding.textureUnits.assign(textures.size(), -1);
 		unsigned int diffuseNr = 1;
 		unsigned int specularNr = 1;
 		unsigned int normalNr = 1;
 		unsigned int heightNr = 1;
 		for (unsigned int i = 0; i < textures.size(); i++)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
 			// retrieve texture number (the N in diffuse_textureN)
 			string number;
-			string name = textures[i].type;
+			const string& name = textures[i].type;
 			if (name == "texture_diffuse")
 				number = std::to_string(diffuseNr++);
 			else if (name == "texture_specular")
@@ -73,28 +259,71 @@ public:
 			else if (name == "texture_height")
 				number = std::to_string(heightNr++); // transfer unsigned int to stream
 
-			// now set the sampler to the correct texture unit
-			glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
-			// and finally bind the texture
-			glBindTexture(GL_TEXTURE_2D, textures[i].id);
+			const string samplerName = name + number;
+			for (const auto& samplerUnit : samplerUnits)
+			{
+				if (samplerUnit.first == samplerName)
+					binding.textureUnits[i] = samplerUnit.second;
+			}
 		}
+		binding.positionOriginLocation = glGetUniformLocation(shader.ID, "positionOrigin");
+		binding.positionScaleLocation = glGetUniformLocation(shader.ID, "positionScale");
+		binding.texCoordOriginLocation = glGetUniformLocation(shader.ID, "texCoordOrigin");
+		binding.texCoordScaleLocation = glGetUniformLocation(shader.ID, "texCoordScale");
+		samplerBindings.push_back(std::move(binding));
+		return samplerBindings.back();
+	}
 
-		// draw mesh
-		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+	// reorders triangles for the post-transform cache and overdraw, then vertices for fetch locality
+	void optimize()
+	{
+		cacheBefore = analyzeVertexCache(indices, vertices.size());
 
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
-	}
+		vector<glm::vec3> positions(vertices.size());
+		for (unsigned int i = 0; i < vertices.size(); i++)
+			positions[i] = vertices[i].Position;
+		optimizeVertexCache(indices, vertices.size());
+		optimizeOverdraw(indices, positions);
+		vertices = remapVertices(vertices, optimizeVertexFetch(indices, vertices.size()));
 
-private:
-	// render data 
-	unsigned int VBO, EBO;
+		cacheAfter = analyzeVertexCache(indices, vertices.size());
+	}
 
 	// initializes all the buffer objects/arrays
-	void setupMesh()
+	void setupMesh(MeshBufferArena* bufferArena)
 	{
+		numVertices = static_cast<unsigned int>(vertices.size());
+		numIndices = static_cast<unsigned int>(indices.size());
+		boundsMin = boundsMax = vertices.empty() ? glm::vec3(0.0f) : vertices[0].Position;
+		for (const auto& vertex : vertices)
+		{
+			boundsMin = glm::min(boundsMin, vertex.Position);
+			boundsMax = glm::max(boundsMax, vertex.Position);
+		}
+
+		// A great thing about structs is that their memory layout is sequential for all its items.
+		// The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
+		// again translates to 3/2 floats which translates to a byte array.
+		vector<QuantizedVertex> quantizedVertices;
+		if (quantized)
+			quantizedVertices = quantizeVertices();
+		const void* vertexData = quantized ? static_cast<const void*>(quantizedVertices.data()) : static_cast<const void*>(vertices.data());
+		const size_t vertexDataSize = vertices.size() * (quantized ? sizeof(QuantizedVertex) : sizeof(Vertex));
+		const VertexFormatDescription format = getVertexFormat(quantized);
+
+		if (bufferArena != nullptr)
+		{
+			// ranges of the shared buffers, indices stay relative to the mesh's first vertex
+			bufferPool = &bufferArena->getPool(format, GL_UNSIGNED_INT);
+			poolAllocation = bufferPool->allocate(static_cast<int>(vertices.size()), static_cast<int>(indices.size()));
+			if (auto target = bufferPool->mapVertices(poolAllocation))
+				memcpy(target, vertexData, vertexDataSize);
+			if (auto target = bufferPool->mapIndices(poolAllocation))
+				memcpy(target, indices.data(), indices.size() * sizeof(unsigned int));
+			bufferPool->unmap();
+			return;
+		}
+
 		// create buffers/arrays
 		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
@@ -103,32 +332,72 @@ private:
 		glBindVertexArray(VAO);
 		// load data into vertex buffers
 		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		// A great thing about structs is that their memory layout is sequential for all its items.
-		// The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-		// again translates to 3/2 floats which translates to a byte array.
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, vertexDataSize, vertexData, GL_STATIC_DRAW);
 
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
 
 		// set the vertex attribute pointers
-		// vertex Positions
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-		// vertex normals
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-		// vertex texture coords
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-		// vertex tangent
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-		// vertex bitangent
-		glEnableVertexAttribArray(4);
-		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+		setVertexAttributePointers(format);
 
 		glBindVertexArray(0);
 	}
+
+	// quantizes vertices relative to the bounds of positions and texture coordinates
+	vector<QuantizedVertex> quantizeVertices()
+	{
+		// quantization ranges are the bounds of positions and texture coordinates
+		glm::vec3 minTexCoords(vertices[0].TexCoords, 0.0f), maxTexCoords(vertices[0].TexCoords, 0.0f);
+		for (const auto& vertex : vertices)
+		{
+			minTexCoords = glm::min(minTexCoords, glm::vec3(vertex.TexCoords, 0.0f));
+			maxTexCoords = glm::max(maxTexCoords, glm::vec3(vertex.TexCoords, 0.0f));
+		}
+		positionRange = computeQuantizationRange(boundsMin, boundsMax);
+		texCoordRange = computeQuantizationRange(minTexCoords, maxTexCoords);
+
+		vector<QuantizedVertex> quantizedVertices(vertices.size());
+		for (unsigned int i = 0; i < vertices.size(); i++)
+		{
+			const auto& vertex = vertices[i];
+			const auto bitangentSign = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? -1.0f : 1.0f;
+			quantizedVertices[i].Position = quantizePosition(vertex.Position, positionRange);
+			quantizedVertices[i].Normal = encodeOctahedral(vertex.Normal);
+			quantizedVertices[i].TexCoords = quantizeTextureCoordinate(vertex.TexCoords, texCoordRange);
+			quantizedVertices[i].Tangent = packTangent(vertex.Tangent, bitangentSign);
+		}
+		return quantizedVertices;
+	}
+};
+
+// totals over all meshes of one load, so that large scenes report once rather than once per mesh
+struct MeshLoadStatistics {
+	size_t numMeshes = 0;
+	size_t numVertices = 0;
+	size_t numTriangles = 0;
+	size_t numTransformedBefore = 0;
+	size_t numTransformedAfter = 0;
+	size_t releasedHostBytes = 0;
+
+	// the loader adds every mesh it has constructed
+	void add(const Mesh& mesh)
+	{
+		numMeshes++;
+		numVertices += mesh.numVertices;
+		numTriangles += mesh.numIndices / 3;
+		numTransformedBefore += mesh.cacheBefore.numTransformed;
+		numTransformedAfter += mesh.cacheAfter.numTransformed;
+		releasedHostBytes += mesh.releasedHostBytes;
+	}
+
+	// and reports them once all are loaded
+	void report() const
+	{
+		const auto triangles = static_cast<double>(std::max<size_t>(numTriangles, 1));
+		const auto vertices = static_cast<double>(std::max<size_t>(numVertices, 1));
+		std::cout << "Loaded " << numMeshes << " meshes (" << numTriangles << " triangles): ACMR " << numTransformedBefore / triangles
+			<< " -> " << numTransformedAfter / triangles << ", ATVR " << numTransformedBefore / vertices << " -> " << numTransformedAfter / vertices
+			<< ", released " << releasedHostBytes / (1024.0 * 1024.0) << " MB of CPU-side vertices and indices" << std::endl;
+	}
 };
 #endif
\ No newline at end of file
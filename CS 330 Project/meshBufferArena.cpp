@@ -0,0 +1,365 @@
+// STL
+#include <iostream>
+#include <algorithm>
+
+// Project
+#include "meshBufferArena.h"
+
+namespace {
+
+size_t getIndexByteSize(GLenum indexType)
+{
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+/**
+ * Creates buffer with uninitialized storage of given size. It is left bound to GL_COPY_WRITE_BUFFER,
+ * which no VAO records, so creating buffers never disturbs vertex array state.
+ */
+GLuint createBuffer(size_t sizeBytes)
+{
+    GLuint result = 0;
+    glGenBuffers(1, &result);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, result);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(sizeBytes), nullptr, GL_STATIC_DRAW);
+    return result;
+}
+
+/**
+ * Range copied by defragmentation, consecutive ranges that stay consecutive are merged into one copy.
+ */
+struct BufferCopy
+{
+    size_t sourceOffset;
+    size_t targetOffset;
+    size_t size;
+};
+
+void copyBufferRanges(GLuint source, GLuint target, const std::vector<BufferCopy>& copies)
+{
+    glBindBuffer(GL_COPY_READ_BUFFER, source);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target);
+    for (const auto& copy : copies)
+    {
+        if (copy.size == 0) {
+            continue;
+        }
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(copy.sourceOffset),
+            static_cast<GLintptr>(copy.targetOffset), static_cast<GLsizeiptr>(copy.size));
+    }
+}
+
+void addBufferCopy(std::vector<BufferCopy>& copies, size_t sourceOffset, size_t targetOffset, size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+
+    if (!copies.empty())
+    {
+        auto& last = copies.back();
+        if (last.sourceOffset + last.size == sourceOffset && last.targetOffset + last.size == targetOffset)
+        {
+            last.size += size;
+            return;
+        }
+    }
+    copies.push_back(BufferCopy{ sourceOffset, targetOffset, size });
+}
+
+} // namespace
+
+MeshBufferPool::MeshBufferPool(const VertexFormatDescription& format, GLenum indexType, size_t initialNumVertices, size_t initialNumIndices)
+    : _format(format)
+    , _indexType(indexType)
+    , _indexByteSize(getIndexByteSize(indexType))
+    , _vertexRanges(initialNumVertices)
+    , _indexRanges(initialNumIndices)
+{
+    glGenVertexArrays(1, &_vao);
+    _vertexBuffer = createBuffer(initialNumVertices * _format.vertexByteSize);
+    _indexBuffer = createBuffer(initialNumIndices * _indexByteSize);
+    attachBuffers();
+}
+
+MeshBufferPool::~MeshBufferPool()
+{
+    unmap();
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vertexBuffer);
+    glDeleteBuffers(1, &_indexBuffer);
+}
+
+int MeshBufferPool::allocate(int numVertices, int numIndices)
+{
+    // Buffers may be replaced, pending writes must go to the current ones
+    unmap();
+
+    Allocation allocation;
+    allocation.numVertices = static_cast<size_t>(numVertices);
+    allocation.numIndices = static_cast<size_t>(numIndices);
+    allocation.isLive = true;
+
+    allocation.firstVertex = _vertexRanges.allocate(allocation.numVertices);
+    if (allocation.firstVertex == RangeAllocator::NO_RANGE)
+    {
+        growVertexBuffer(allocation.numVertices);
+        allocation.firstVertex = _vertexRanges.allocate(allocation.numVertices);
+    }
+    allocation.firstIndex = _indexRanges.allocate(allocation.numIndices);
+    if (allocation.firstIndex == RangeAllocator::NO_RANGE)
+    {
+        growIndexBuffer(allocation.numIndices);
+        allocation.firstIndex = _indexRanges.allocate(allocation.numIndices);
+    }
+
+    _numLiveAllocations++;
+    if (!_freeHandles.empty())
+    {
+        const auto handle = _freeHandles.back();
+        _freeHandles.pop_back();
+        _allocations[handle] = allocation;
+        return handle;
+    }
+
+    _allocations.push_back(allocation);
+    return static_cast<int>(_allocations.size()) - 1;
+}
+
+void MeshBufferPool::free(int allocation)
+{
+    if (allocation < 0 || allocation >= static_cast<int>(_allocations.size()) || !_allocations[allocation].isLive) {
+        return;
+    }
+
+    auto& ranges = _allocations[allocation];
+    _vertexRanges.free(ranges.firstVertex, ranges.numVertices);
+    _indexRanges.free(ranges.firstIndex, ranges.numIndices);
+    ranges.isLive = false;
+    _freeHandles.push_back(allocation);
+    _numLiveAllocations--;
+}
+
+unsigned char* MeshBufferPool::mapVertices(int allocation)
+{
+    const auto& ranges = _allocations[allocation];
+    return mapRange(_vertexBuffer, ranges.firstVertex * _format.vertexByteSize, ranges.numVertices * _format.vertexByteSize);
+}
+
+unsigned char* MeshBufferPool::mapIndices(int allocation)
+{
+    const auto& ranges = _allocations[allocation];
+    return mapRange(_indexBuffer, ranges.firstIndex * _indexByteSize, ranges.numIndices * _indexByteSize);
+}
+
+void MeshBufferPool::unmap()
+{
+    if (_mappedBuffer == 0) {
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _mappedBuffer);
+    if (_staging)
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(_mappedOffset), static_cast<GLsizeiptr>(_mappedSize), _staging->getData());
+        StagingArena::recycle(std::move(_staging));
+    }
+    else if (glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_FALSE) {
+        std::cerr << "Mesh buffer pool data got corrupted while mapped!" << std::endl;
+    }
+
+    _mappedBuffer = 0;
+}
+
+void MeshBufferPool::bindVertexArray() const
+{
+    glBindVertexArray(_vao);
+}
+
+void MeshBufferPool::draw(int allocation, int numInstances) const
+{
+    const auto range = getDrawRange(allocation);
+    const auto indices = reinterpret_cast<void*>(range.firstIndexByteOffset);
+    if (numInstances == 1) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, range.numIndices, _indexType, indices, range.baseVertex);
+    }
+    else {
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.numIndices, _indexType, indices, numInstances, range.baseVertex);
+    }
+}
+
+MeshDrawRange MeshBufferPool::getDrawRange(int allocation) const
+{
+    const auto& ranges = _allocations[allocation];
+    MeshDrawRange result;
+    result.numIndices = static_cast<GLsizei>(ranges.numIndices);
+    result.firstIndexByteOffset = ranges.firstIndex * _indexByteSize;
+    result.baseVertex = static_cast<GLint>(ranges.firstVertex);
+    return result;
+}
+
+void MeshBufferPool::defragment()
+{
+    unmap();
+    if (!isFragmented()) {
+        return;
+    }
+
+    // Allocations in buffer order, packed from the start (separately for vertices and indices)
+    std::vector<int> byVertices;
+    for (auto handle = 0; handle < static_cast<int>(_allocations.size()); handle++)
+    {
+        if (_allocations[handle].isLive) {
+            byVertices.push_back(handle);
+        }
+    }
+    auto byIndices = byVertices;
+    std::sort(byVertices.begin(), byVertices.end(), [this](int first, int second) {
+        return _allocations[first].firstVertex < _allocations[second].firstVertex;
+    });
+    std::sort(byIndices.begin(), byIndices.end(), [this](int first, int second) {
+        return _allocations[first].firstIndex < _allocations[second].firstIndex;
+    });
+
+    std::vector<BufferCopy> vertexCopies;
+    _vertexRanges.reset(_vertexRanges.getCapacity());
+    for (const auto handle : byVertices)
+    {
+        auto& ranges = _allocations[handle];
+        const auto firstVertex = _vertexRanges.allocate(ranges.numVertices);
+        addBufferCopy(vertexCopies, ranges.firstVertex * _format.vertexByteSize, firstVertex * _format.vertexByteSize, ranges.numVertices * _format.vertexByteSize);
+        ranges.firstVertex = firstVertex;
+    }
+
+    std::vector<BufferCopy> indexCopies;
+    _indexRanges.reset(_indexRanges.getCapacity());
+    for (const auto handle : byIndices)
+    {
+        auto& ranges = _allocations[handle];
+        const auto firstIndex = _indexRanges.allocate(ranges.numIndices);
+        addBufferCopy(indexCopies, ranges.firstIndex * _indexByteSize, firstIndex * _indexByteSize, ranges.numIndices * _indexByteSize);
+        ranges.firstIndex = firstIndex;
+    }
+
+    // Copies go to new buffers, ranges of one buffer must not overlap
+    const auto vertexBuffer = createBuffer(_vertexRanges.getCapacity() * _format.vertexByteSize);
+    copyBufferRanges(_vertexBuffer, vertexBuffer, vertexCopies);
+    const auto indexBuffer = createBuffer(_indexRanges.getCapacity() * _indexByteSize);
+    copyBufferRanges(_indexBuffer, indexBuffer, indexCopies);
+
+    glDeleteBuffers(1, &_vertexBuffer);
+    glDeleteBuffers(1, &_indexBuffer);
+    _vertexBuffer = vertexBuffer;
+    _indexBuffer = indexBuffer;
+    attachBuffers();
+}
+
+const VertexFormatDescription& MeshBufferPool::getFormat() const
+{
+    return _format;
+}
+
+GLenum MeshBufferPool::getIndexType() const
+{
+    return _indexType;
+}
+
+int MeshBufferPool::getNumAllocations() const
+{
+    return _numLiveAllocations;
+}
+
+bool MeshBufferPool::isFragmented() const
+{
+    return !_vertexRanges.isPacked() || !_indexRanges.isPacked();
+}
+
+size_t MeshBufferPool::getByteSize() const
+{
+    return _vertexRanges.getCapacity() * _format.vertexByteSize + _indexRanges.getCapacity() * _indexByteSize;
+}
+
+unsigned char* MeshBufferPool::mapRange(GLuint buffer, size_t offset, size_t size)
+{
+    unmap();
+    if (size == 0) {
+        return nullptr;
+    }
+
+    _mappedBuffer = buffer;
+    _mappedOffset = offset;
+    _mappedSize = size;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    const auto result = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (result != nullptr) {
+        return static_cast<unsigned char*>(result);
+    }
+
+    // Staged data is uploaded on unmap instead
+    _staging = StagingArena::acquire(size);
+    return _staging->allocate(size);
+}
+
+void MeshBufferPool::growVertexBuffer(size_t numVertices)
+{
+    const auto oldCapacity = _vertexRanges.getCapacity();
+    const auto newCapacity = std::max(oldCapacity * 2, oldCapacity + numVertices);
+    const auto vertexBuffer = createBuffer(newCapacity * _format.vertexByteSize);
+    copyBufferRanges(_vertexBuffer, vertexBuffer, { BufferCopy{ 0, 0, oldCapacity * _format.vertexByteSize } });
+    glDeleteBuffers(1, &_vertexBuffer);
+    _vertexBuffer = vertexBuffer;
+    _vertexRanges.grow(newCapacity);
+    attachBuffers();
+}
+
+void MeshBufferPool::growIndexBuffer(size_t numIndices)
+{
+    const auto oldCapacity = _indexRanges.getCapacity();
+    const auto newCapacity = std::max(oldCapacity * 2, oldCapacity + numIndices);
+    const auto indexBuffer = createBuffer(newCapacity * _indexByteSize);
+    copyBufferRanges(_indexBuffer, indexBuffer, { BufferCopy{ 0, 0, oldCapacity * _indexByteSize } });
+    glDeleteBuffers(1, &_indexBuffer);
+    _indexBuffer = indexBuffer;
+    _indexRanges.grow(newCapacity);
+    attachBuffers();
+}
+
+void MeshBufferPool::attachBuffers()
+{
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+    setVertexAttributePointers(_format);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+    glBindVertexArray(0);
+}
+
+MeshBufferArena::MeshBufferArena(size_t initialVertexBufferSize, size_t initialIndexBufferSize)
+    : _initialVertexBufferSize(initialVertexBufferSize)
+    , _initialIndexBufferSize(initialIndexBufferSize) {}
+
+MeshBufferPool& MeshBufferArena::getPool(const VertexFormatDescription& format, GLenum indexType)
+{
+    for (const auto& pool : _pools)
+    {
+        if (pool->getIndexType() == indexType && pool->getFormat() == format) {
+            return *pool;
+        }
+    }
+
+    const auto initialNumVertices = format.vertexByteSize > 0 ? _initialVertexBufferSize / format.vertexByteSize : 0;
+    const auto initialNumIndices = _initialIndexBufferSize / getIndexByteSize(indexType);
+    _pools.emplace_back(new MeshBufferPool(format, indexType, initialNumVertices, initialNumIndices));
+    return *_pools.back();
+}
+
+void MeshBufferArena::defragment()
+{
+    for (const auto& pool : _pools) {
+        pool->defragment();
+    }
+}
+
+size_t MeshBufferArena::getNumPools() const
+{
+    return _pools.size();
+}
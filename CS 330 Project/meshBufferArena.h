@@ -0,0 +1,193 @@
+#pragma once
+// STL
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// Project
+#include "vertexFormatDescription.h"
+#include "rangeAllocator.h"
+#include "stagingArena.h"
+
+/**
+ * What a draw call of one mesh in a buffer pool needs, e.g. to fill arrays of glMultiDrawElementsBaseVertex.
+ */
+struct MeshDrawRange
+{
+    GLsizei numIndices; // Number of indices to draw
+    size_t firstIndexByteOffset; // Byte offset of the first index in the pool's element buffer
+    GLint baseVertex; // Added to every index, the mesh's first vertex in the pool's vertex buffer
+};
+
+/**
+ * Vertex and index ranges of many meshes sub-allocated from one vertex buffer and one element buffer,
+ * with one VAO for all of them. Every mesh in the pool has the same vertex format and index type and
+ * uses indices relative to its own first vertex, so meshes draw with base vertex offsets and drawing
+ * many of them needs no VAO switches. Buffers grow by copying on the GPU when a range doesn't fit,
+ * and defragment() packs the ranges when freed holes pile up. Must be used from the GL thread only.
+ */
+class MeshBufferPool
+{
+public:
+    /**
+     * @param format              Format of all vertices in the pool (attribute offsets relative to the vertex)
+     * @param indexType           GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     * @param initialNumVertices  Number of vertices the vertex buffer has room for at first
+     * @param initialNumIndices   Number of indices the element buffer has room for at first
+     */
+    MeshBufferPool(const VertexFormatDescription& format, GLenum indexType, size_t initialNumVertices, size_t initialNumIndices);
+    ~MeshBufferPool();
+
+    MeshBufferPool(const MeshBufferPool&) = delete;
+    MeshBufferPool& operator=(const MeshBufferPool&) = delete;
+
+    /**
+     * Allocates vertex and index ranges for one mesh, growing the buffers if they don't fit.
+     *
+     * @return Allocation handle, valid until freed (ranges may move on defragmentation, handles stay).
+     */
+    int allocate(int numVertices, int numIndices);
+
+    /**
+     * Frees ranges of given allocation.
+     */
+    void free(int allocation);
+
+    /**
+     * Maps vertex range of given allocation for writing (only one range may be mapped at a time).
+     *
+     * @return Pointer to write the vertices to, valid until unmap().
+     */
+    unsigned char* mapVertices(int allocation);
+
+    /**
+     * Maps index range of given allocation for writing (only one range may be mapped at a time).
+     *
+     * @return Pointer to write the indices to, valid until unmap().
+     */
+    unsigned char* mapIndices(int allocation);
+
+    /**
+     * Finishes writing the mapped range.
+     */
+    void unmap();
+
+    /**
+     * Binds the VAO shared by all meshes of the pool.
+     */
+    void bindVertexArray() const;
+
+    /**
+     * Draws triangles of given allocation. The pool's VAO must be bound.
+     */
+    void draw(int allocation, int numInstances = 1) const;
+
+    /**
+     * Gets draw parameters of given allocation, for batching draws of many meshes.
+     */
+    MeshDrawRange getDrawRange(int allocation) const;
+
+    /**
+     * Moves all ranges to the start of the buffers (copying on the GPU), so that the free space is one block again.
+     */
+    void defragment();
+
+    /**
+     * Gets format of the vertices in the pool.
+     */
+    const VertexFormatDescription& getFormat() const;
+
+    /**
+     * Gets type of the indices in the pool.
+     */
+    GLenum getIndexType() const;
+
+    /**
+     * Gets number of live allocations.
+     */
+    int getNumAllocations() const;
+
+    /**
+     * Checks, if there are free holes between the ranges (defragment() gets rid of them).
+     */
+    bool isFragmented() const;
+
+    /**
+     * Gets number of bytes of both buffers together.
+     */
+    size_t getByteSize() const;
+
+private:
+    /**
+     * Ranges of one mesh, in vertices and indices.
+     */
+    struct Allocation
+    {
+        size_t firstVertex;
+        size_t numVertices;
+        size_t firstIndex;
+        size_t numIndices;
+        bool isLive;
+    };
+
+    VertexFormatDescription _format; // Format of all vertices
+    GLenum _indexType; // Type of all indices
+    size_t _indexByteSize; // Size of one index in bytes
+    GLuint _vao = 0; // VAO shared by all meshes
+    GLuint _vertexBuffer = 0; // Vertex buffer shared by all meshes
+    GLuint _indexBuffer = 0; // Element buffer shared by all meshes
+    RangeAllocator _vertexRanges; // Ranges of the vertex buffer, in vertices
+    RangeAllocator _indexRanges; // Ranges of the element buffer, in indices
+    std::vector<Allocation> _allocations; // Allocations by handle
+    std::vector<int> _freeHandles; // Handles of freed allocations, to be reused
+    int _numLiveAllocations = 0; // Number of allocated handles
+
+    GLuint _mappedBuffer = 0; // Buffer of the mapped range, 0 if none is mapped
+    size_t _mappedOffset = 0; // Byte offset of the mapped range
+    size_t _mappedSize = 0; // Byte size of the mapped range
+    std::unique_ptr<StagingArena> _staging; // Holds the mapped range's data instead, if the GL could not map it
+
+    unsigned char* mapRange(GLuint buffer, size_t offset, size_t size);
+    void growVertexBuffer(size_t numVertices);
+    void growIndexBuffer(size_t numIndices);
+    void attachBuffers();
+};
+
+/**
+ * Set of buffer pools, one for every vertex format and index type, so that meshes just ask for the pool
+ * matching their vertices. Pools are never removed, the arena must outlive all meshes allocated from it.
+ */
+class MeshBufferArena
+{
+public:
+    /**
+     * @param initialVertexBufferSize  Size of the vertex buffer of every new pool in bytes
+     * @param initialIndexBufferSize   Size of the element buffer of every new pool in bytes
+     */
+    explicit MeshBufferArena(size_t initialVertexBufferSize = 4 * 1024 * 1024, size_t initialIndexBufferSize = 2 * 1024 * 1024);
+
+    MeshBufferArena(const MeshBufferArena&) = delete;
+    MeshBufferArena& operator=(const MeshBufferArena&) = delete;
+
+    /**
+     * Gets pool for given vertex format and index type, creating it on first use.
+     */
+    MeshBufferPool& getPool(const VertexFormatDescription& format, GLenum indexType);
+
+    /**
+     * Defragments every pool that has holes between its ranges. Do it between frames, after many meshes were deleted.
+     */
+    void defragment();
+
+    /**
+     * Gets number of pools (vertex format and index type combinations) created so far.
+     */
+    size_t getNumPools() const;
+
+private:
+    size_t _initialVertexBufferSize; // Size of the vertex buffer of new pools in bytes
+    size_t _initialIndexBufferSize; // Size of the element buffer of new pools in bytes
+    std::vector<std::unique_ptr<MeshBufferPool>> _pools; // All pools created so far
+};
@@ -0,0 +1,328 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "meshOptimizer.h"
+
+namespace {
+
+/**
+ * FIFO post-transform cache simulated with time stamps: a vertex is cached, if fewer than
+ * cacheSize misses happened since its own miss. Flushing just moves the clock past every stamp.
+ */
+class VertexCacheSimulation
+{
+public:
+    VertexCacheSimulation(size_t numVertices, int cacheSize)
+        : _cacheTimes(numVertices, 0)
+        , _cacheSize(static_cast<unsigned int>(cacheSize))
+        , _timestamp(_cacheSize + 1) {}
+
+    /**
+     * Gets number of vertices of given triangle the cache misses (and puts them in the cache).
+     */
+    int processTriangle(const unsigned int* triangle)
+    {
+        auto result = 0;
+        for (auto corner = 0; corner < 3; corner++)
+        {
+            const auto vertex = triangle[corner];
+            if (_timestamp - _cacheTimes[vertex] > _cacheSize)
+            {
+                _cacheTimes[vertex] = _timestamp++;
+                result++;
+            }
+        }
+
+        return result;
+    }
+
+    void flush()
+    {
+        _timestamp += _cacheSize + 1;
+    }
+
+private:
+    std::vector<unsigned int> _cacheTimes; // Time stamp of every vertex's last miss
+    unsigned int _cacheSize; // Number of cache entries
+    unsigned int _timestamp; // Incremented on every miss
+};
+
+/**
+ * Triangles using every vertex, stored compactly: triangles of vertex v are triangles[offsets[v] .. offsets[v + 1]).
+ */
+struct VertexTriangleAdjacency
+{
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> triangles;
+};
+
+VertexTriangleAdjacency buildAdjacency(const std::vector<unsigned int>& indices, size_t numVertices)
+{
+    VertexTriangleAdjacency result;
+    result.offsets.assign(numVertices + 1, 0);
+    for (const auto index : indices) {
+        result.offsets[index + 1]++;
+    }
+    for (size_t vertex = 0; vertex < numVertices; vertex++) {
+        result.offsets[vertex + 1] += result.offsets[vertex];
+    }
+
+    std::vector<unsigned int> fillCounts(result.offsets.begin(), result.offsets.end() - 1);
+    result.triangles.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        result.triangles[fillCounts[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    return result;
+}
+
+/**
+ * Range of triangles drawn together, the unit overdraw optimization moves around.
+ */
+struct TriangleCluster
+{
+    size_t firstTriangle;
+    size_t numTriangles;
+    float sortKey; // Distance of the cluster's plane in front of the mesh centroid, larger is drawn first
+};
+
+} // namespace
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int>& indices, size_t numVertices, int cacheSize)
+{
+    VertexCacheStatistics result;
+    const auto numTriangles = indices.size() / 3;
+    if (numTriangles == 0) {
+        return result;
+    }
+
+    VertexCacheSimulation cache(numVertices, cacheSize);
+    for (size_t triangle = 0; triangle < numTriangles; triangle++) {
+        result.numTransformed += cache.processTriangle(&indices[triangle * 3]);
+    }
+
+    std::vector<bool> isReferenced(numVertices, false);
+    size_t numReferenced = 0;
+    for (const auto index : indices)
+    {
+        if (!isReferenced[index])
+        {
+            isReferenced[index] = true;
+            numReferenced++;
+        }
+    }
+
+    result.acmr = static_cast<float>(result.numTransformed) / numTriangles;
+    result.atvr = static_cast<float>(result.numTransformed) / numReferenced;
+    return result;
+}
+
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t numVertices, int cacheSize)
+{
+    const auto numTriangles = indices.size() / 3;
+    if (numTriangles == 0) {
+        return;
+    }
+
+    const auto adjacency = buildAdjacency(indices, numVertices);
+    std::vector<unsigned int> liveTriangles(numVertices); // Triangles not emitted yet, per vertex
+    for (size_t vertex = 0; vertex < numVertices; vertex++) {
+        liveTriangles[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+    }
+
+    const auto cacheEntries = static_cast<unsigned int>(cacheSize);
+    std::vector<unsigned int> cacheTimes(numVertices, 0);
+    auto timestamp = cacheEntries + 1;
+    std::vector<bool> isEmitted(numTriangles, false);
+    std::vector<unsigned int> deadEnds; // Vertices of emitted triangles, the most recent on top
+    std::vector<unsigned int> candidates; // Vertices of triangles emitted around the current fanning vertex
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    size_t nextInputVertex = 0; // Scan position for the case that no dead-end is left
+    const auto skipDeadEnd = [&]() -> long long
+    {
+        while (!deadEnds.empty())
+        {
+            const auto vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return vertex;
+            }
+        }
+        for (; nextInputVertex < numVertices; nextInputVertex++)
+        {
+            if (liveTriangles[nextInputVertex] > 0) {
+                return static_cast<long long>(nextInputVertex);
+            }
+        }
+
+        return -1;
+    };
+
+    auto fanningVertex = skipDeadEnd();
+    while (fanningVertex >= 0)
+    {
+        // Emit all remaining triangles around the fanning vertex
+        candidates.clear();
+        for (auto i = adjacency.offsets[fanningVertex]; i < adjacency.offsets[fanningVertex + 1]; i++)
+        {
+            const auto triangle = adjacency.triangles[i];
+            if (isEmitted[triangle]) {
+                continue;
+            }
+
+            for (auto corner = 0; corner < 3; corner++)
+            {
+                const auto vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timestamp - cacheTimes[vertex] > cacheEntries) {
+                    cacheTimes[vertex] = timestamp++;
+                }
+            }
+            isEmitted[triangle] = true;
+        }
+
+        // Continue with the candidate that entered the cache earliest, but still stays in it while its fan is emitted
+        long long nextVertex = -1;
+        auto bestPriority = -1LL;
+        for (const auto vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+
+            auto priority = 0LL;
+            if (timestamp - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheEntries) {
+                priority = timestamp - cacheTimes[vertex];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+
+        fanningVertex = nextVertex >= 0 ? nextVertex : skipDeadEnd();
+    }
+
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<glm::vec3>& positions, float threshold, int cacheSize)
+{
+    const auto numTriangles = indices.size() / 3;
+    if (numTriangles == 0) {
+        return;
+    }
+
+    // Hard boundaries: triangles all of whose vertices miss, the cache is cold there anyway
+    VertexCacheSimulation cache(positions.size(), cacheSize);
+    std::vector<size_t> hardBoundaries;
+    for (size_t triangle = 0; triangle < numTriangles; triangle++)
+    {
+        if (cache.processTriangle(&indices[triangle * 3]) == 3) {
+            hardBoundaries.push_back(triangle);
+        }
+    }
+    hardBoundaries.push_back(numTriangles);
+
+    // Soft boundaries: split hard clusters wherever the part so far is about as cache efficient as the whole
+    std::vector<TriangleCluster> clusters;
+    for (size_t i = 0; i + 1 < hardBoundaries.size(); i++)
+    {
+        const auto begin = hardBoundaries[i];
+        const auto end = hardBoundaries[i + 1];
+
+        cache.flush();
+        size_t hardMisses = 0;
+        for (auto triangle = begin; triangle < end; triangle++) {
+            hardMisses += cache.processTriangle(&indices[triangle * 3]);
+        }
+        const auto clusterThreshold = threshold * hardMisses / (end - begin);
+
+        cache.flush();
+        auto clusterBegin = begin;
+        size_t clusterMisses = 0;
+        for (auto triangle = begin; triangle < end; triangle++)
+        {
+            clusterMisses += cache.processTriangle(&indices[triangle * 3]);
+            const auto isLast = triangle + 1 == end;
+            if (isLast || static_cast<float>(clusterMisses) / (triangle + 1 - clusterBegin) <= clusterThreshold)
+            {
+                clusters.push_back(TriangleCluster{ clusterBegin, triangle + 1 - clusterBegin, 0.0f });
+                clusterBegin = triangle + 1;
+                clusterMisses = 0;
+                cache.flush();
+            }
+        }
+    }
+
+    // Sort key: how far the cluster's plane lies outside the mesh centroid, outer clusters occlude inner ones
+    glm::vec3 meshCentroid(0.0f);
+    auto meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCentroids(clusters.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusters.size(), glm::vec3(0.0f));
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        auto clusterArea = 0.0f;
+        for (auto triangle = clusters[c].firstTriangle; triangle < clusters[c].firstTriangle + clusters[c].numTriangles; triangle++)
+        {
+            const auto& p0 = positions[indices[triangle * 3]];
+            const auto& p1 = positions[indices[triangle * 3 + 1]];
+            const auto& p2 = positions[indices[triangle * 3 + 2]];
+            const auto normal = glm::cross(p1 - p0, p2 - p0);
+            const auto area = glm::length(normal);
+            const auto weightedCentroid = (p0 + p1 + p2) * (area / 3.0f);
+
+            clusterCentroids[c] += weightedCentroid;
+            clusterNormals[c] += normal;
+            clusterArea += area;
+            meshCentroid += weightedCentroid;
+            meshArea += area;
+        }
+        if (clusterArea > 0.0f) {
+            clusterCentroids[c] = clusterCentroids[c] / clusterArea;
+        }
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid = meshCentroid / meshArea;
+    }
+
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        const auto normalLength = glm::length(clusterNormals[c]);
+        if (normalLength > 0.0f) {
+            clusters[c].sortKey = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / normalLength);
+        }
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const TriangleCluster& first, const TriangleCluster& second) {
+        return first.sortKey > second.sortKey;
+    });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const auto& cluster : clusters) {
+        result.insert(result.end(), indices.begin() + cluster.firstTriangle * 3, indices.begin() + (cluster.firstTriangle + cluster.numTriangles) * 3);
+    }
+    indices.swap(result);
+}
+
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int>& indices, size_t numVertices)
+{
+    std::vector<unsigned int> remap(numVertices, NO_VERTEX);
+    unsigned int numUsed = 0;
+    for (auto& index : indices)
+    {
+        if (remap[index] == NO_VERTEX) {
+            remap[index] = numUsed++;
+        }
+        index = remap[index];
+    }
+
+    return remap;
+}
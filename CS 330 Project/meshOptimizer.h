@@ -0,0 +1,80 @@
+#pragma once
+// STL
+#include <vector>
+#include <cstddef>
+
+// GLM
+#include <glm/glm.hpp>
+
+const int VERTEX_CACHE_SIZE = 16; // Post-transform cache entries the optimizer plans for (FIFO)
+const unsigned int NO_VERTEX = ~0u; // Remap table entry of vertices no triangle uses
+
+/**
+ * Post-transform vertex cache efficiency of an indexed triangle list, simulated with a FIFO cache.
+ */
+struct VertexCacheStatistics
+{
+    size_t numTransformed = 0; // Vertex shader invocations (cache misses)
+    float acmr = 0.0f; // Average cache miss ratio, transformed vertices per triangle (0.5 at best, 3 at worst)
+    float atvr = 0.0f; // Average transformed vertex ratio, transformed per referenced vertex (1 at best)
+};
+
+/**
+ * Simulates post-transform vertex cache of given size over an indexed triangle list.
+ *
+ * @param indices      Three indices per triangle
+ * @param numVertices  Number of vertices the indices refer to
+ * @param cacheSize    Number of cache entries
+ */
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int>& indices, size_t numVertices, int cacheSize = VERTEX_CACHE_SIZE);
+
+/**
+ * Reorders triangles for post-transform vertex cache locality (Tipsify, Sander et al. 2007):
+ * fans triangles around the most recently used vertex that is still in the cache, and jumps
+ * to a dead-end vertex only when no fan can continue. Linear in the number of triangles.
+ */
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t numVertices, int cacheSize = VERTEX_CACHE_SIZE);
+
+/**
+ * Reorders clusters of a cache-optimized triangle list to reduce overdraw: splits it where the cache
+ * starts cold and wherever a cluster's own miss ratio stays within threshold times the list's ratio,
+ * then draws clusters facing away from the mesh center first, so that they occlude the rest.
+ *
+ * @param indices    Three indices per triangle, already optimized by optimizeVertexCache
+ * @param positions  Position of every vertex
+ * @param threshold  Allowed ACMR increase (1.05 lets it grow by 5 %)
+ */
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f, int cacheSize = VERTEX_CACHE_SIZE);
+
+/**
+ * Renumbers vertices in the order the indices first use them, so that vertex fetch walks memory
+ * sequentially. Rewrites the indices, the caller moves the vertices by the returned remap table.
+ *
+ * @return New index of every old vertex, NO_VERTEX for vertices no triangle uses (they can be dropped).
+ */
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int>& indices, size_t numVertices);
+
+/**
+ * Moves vertices to their new indices from optimizeVertexFetch, dropping unused ones.
+ */
+template<typename T>
+std::vector<T> remapVertices(const std::vector<T>& vertices, const std::vector<unsigned int>& remap)
+{
+    size_t numUsed = 0;
+    for (const auto newIndex : remap)
+    {
+        if (newIndex != NO_VERTEX) {
+            numUsed++;
+        }
+    }
+
+    std::vector<T> result(numUsed);
+    for (size_t i = 0; i < remap.size(); i++)
+    {
+        if (remap[i] != NO_VERTEX) {
+            result[remap[i]] = vertices[i];
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,135 @@
+// Project
+#include "pixelUnpackRing.h"
+
+namespace {
+
+const size_t RANGE_ALIGNMENT = 16; // Keeps every range aligned for any pixel type and block format
+const GLuint64 WAIT_TIMEOUT_NANOSECONDS = 1000000000; // 1 second per wait
+
+size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+PixelUnpackRing::PixelUnpackRing(size_t size)
+    : _size(size)
+{
+    glGenBuffers(1, &_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(_size), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+PixelUnpackRing::~PixelUnpackRing()
+{
+    for (const auto& range : _liveRanges)
+    {
+        if (range.fence != nullptr) {
+            glDeleteSync(range.fence);
+        }
+    }
+    glDeleteBuffers(1, &_buffer);
+}
+
+unsigned char* PixelUnpackRing::map(size_t size, bool waitForSpace)
+{
+    if (size == 0 || size > _size) {
+        return nullptr;
+    }
+
+    for (;;)
+    {
+        retireFinishedRanges();
+
+        // Allocate right after the previous range, or from the start if it doesn't fit before the end
+        auto begin = _head;
+        if (begin + size > _size) {
+            begin = 0;
+        }
+
+        if (!overlapsLiveRange(begin, begin + size))
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+            // Fences guarantee the GPU is done with the range, so the driver need not synchronize
+            const auto data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(begin), static_cast<GLsizeiptr>(size),
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (data == nullptr) {
+                return nullptr;
+            }
+
+            _liveRanges.push_back(Range{ begin, begin + size, nullptr });
+            _mappedOffset = begin;
+            _head = alignUp(begin + size, RANGE_ALIGNMENT);
+            return static_cast<unsigned char*>(data);
+        }
+
+        if (!waitForSpace) {
+            return nullptr;
+        }
+
+        // Wait for the oldest range, it is the first to be freed
+        auto& oldestRange = _liveRanges.front();
+        if (oldestRange.fence == nullptr) {
+            fence();
+        }
+        glClientWaitSync(oldestRange.fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NANOSECONDS);
+    }
+}
+
+size_t PixelUnpackRing::unmap()
+{
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    return _mappedOffset;
+}
+
+void PixelUnpackRing::fence()
+{
+    for (auto& range : _liveRanges)
+    {
+        if (range.fence == nullptr) {
+            range.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+}
+
+void PixelUnpackRing::unbind()
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+size_t PixelUnpackRing::getSize() const
+{
+    return _size;
+}
+
+void PixelUnpackRing::retireFinishedRanges()
+{
+    while (!_liveRanges.empty() && _liveRanges.front().fence != nullptr)
+    {
+        const auto status = glClientWaitSync(_liveRanges.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+
+        glDeleteSync(_liveRanges.front().fence);
+        _liveRanges.pop_front();
+    }
+
+    if (_liveRanges.empty()) {
+        _head = 0;
+    }
+}
+
+bool PixelUnpackRing::overlapsLiveRange(size_t begin, size_t end) const
+{
+    for (const auto& range : _liveRanges)
+    {
+        if (begin < range.end && range.begin < end) {
+            return true;
+        }
+    }
+
+    return false;
+}
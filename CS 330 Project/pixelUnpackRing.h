@@ -0,0 +1,75 @@
+#pragma once
+// STL
+#include <deque>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+/**
+ * Ring of staging memory in one pixel unpack buffer (PBO) for texture uploads. Pixels are
+ * written straight into mapped buffer ranges and textures are then filled from the buffer,
+ * so the driver does not make its own copy of client memory and the upload does not block
+ * the GL thread. Ranges are mapped unsynchronized; fences tell when the GPU is done reading
+ * a range, so that it can be reused. Must be used from the GL thread only.
+ */
+class PixelUnpackRing
+{
+public:
+    /**
+     * @param size  Size of the staging buffer in bytes
+     */
+    explicit PixelUnpackRing(size_t size);
+    ~PixelUnpackRing();
+
+    PixelUnpackRing(const PixelUnpackRing&) = delete;
+    PixelUnpackRing& operator=(const PixelUnpackRing&) = delete;
+
+    /**
+     * Reserves and maps range of the ring. The buffer is left bound to GL_PIXEL_UNPACK_BUFFER.
+     *
+     * @param size           Number of bytes to map, at most getSize()
+     * @param waitForSpace   Wait for the GPU to finish with older ranges, if the ring is full
+     *
+     * @return Pointer to write pixels to, or nullptr if the ring is full (and not waiting) or too small.
+     */
+    unsigned char* map(size_t size, bool waitForSpace);
+
+    /**
+     * Unmaps the range mapped by map(). The buffer stays bound to GL_PIXEL_UNPACK_BUFFER.
+     *
+     * @return Offset of the range in the buffer, to be passed as the pixels pointer of glTexSubImage2D and others.
+     */
+    size_t unmap();
+
+    /**
+     * Inserts fence for all ranges unmapped since the last fence. Call after the uploads reading them are issued.
+     */
+    void fence();
+
+    /**
+     * Unbinds any buffer from GL_PIXEL_UNPACK_BUFFER, so that uploads read client memory again.
+     */
+    static void unbind();
+
+    /**
+     * Gets size of the staging buffer in bytes.
+     */
+    size_t getSize() const;
+
+private:
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+        GLsync fence; // Null until fence() is called
+    };
+
+    GLuint _buffer = 0; // Pixel unpack buffer
+    size_t _size; // Size of the buffer in bytes
+    size_t _head = 0; // Where the next range is allocated from
+    size_t _mappedOffset = 0; // Offset of currently mapped range
+    std::deque<Range> _liveRanges; // Ranges the GPU may still read, oldest first
+
+    void retireFinishedRanges();
+    bool overlapsLiveRange(size_t begin, size_t end) const;
+};
@@ -0,0 +1,69 @@
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "planeGrid.h"
+
+namespace static_meshes_3D {
+
+	PlaneGrid::PlaneGrid(float width, float depth, int numColumns, int numRows, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat, MeshBufferArena* bufferArena)
+		: IndexedMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat, bufferArena)
+		, _width(width)
+		, _depth(depth)
+		, _numColumns(numColumns)
+		, _numRows(numRows)
+	{
+		initializeData();
+	}
+
+	float PlaneGrid::getWidth() const
+	{
+		return _width;
+	}
+
+	float PlaneGrid::getDepth() const
+	{
+		return _depth;
+	}
+
+	int PlaneGrid::getColumns() const
+	{
+		return _numColumns;
+	}
+
+	int PlaneGrid::getRows() const
+	{
+		return _numRows;
+	}
+
+	void PlaneGrid::initializeData()
+	{
+		const auto halfSize = glm::vec3(_width / 2.0f, 0.0f, _depth / 2.0f);
+		generate((_numColumns + 1) * (_numRows + 1), IndexWriter::getNumGridTriangles(_numColumns, _numRows) * 3, -halfSize, halfSize);
+	}
+
+	void PlaneGrid::writeVertices(VertexWriter& vertices) const
+	{
+		const auto stepU = 1.0f / float(_numColumns);
+		const auto stepV = 1.0f / float(_numRows);
+		for (auto row = 0; row <= _numRows; row++)
+		{
+			const auto v = row * stepV;
+			const auto z = _depth / 2.0f - v * _depth;
+			for (auto column = 0; column <= _numColumns; column++)
+			{
+				const auto u = column * stepU;
+				vertices.addPosition(glm::vec3(u * _width - _width / 2.0f, 0.0f, z));
+				vertices.addTextureCoordinate(glm::vec2(u, v));
+			}
+		}
+
+		vertices.addNormal(glm::vec3(0.0f, 1.0f, 0.0f), getNumVertices());
+	}
+
+	void PlaneGrid::writeIndices(IndexWriter& indices) const
+	{
+		indices.addGrid(0, _numColumns, _numRows);
+	}
+
+} // namespace static_meshes_3D
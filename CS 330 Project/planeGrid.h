@@ -0,0 +1,49 @@
+#pragma once
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Flat grid in the XZ plane centered at the origin, facing +Y. Texture spans the whole grid
+	* (U along +X, V along -Z). Subdivide it for per-vertex effects or vertex displacement.
+	*/
+	class PlaneGrid : public IndexedMesh3D
+	{
+	public:
+		PlaneGrid(float width, float depth, int numColumns, int numRows,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
+
+		/**
+		 * Gets grid width (along X).
+		 */
+		float getWidth() const;
+
+		/**
+		 * Gets grid depth (along Z).
+		 */
+		float getDepth() const;
+
+		/**
+		 * Gets number of grid cells along X.
+		 */
+		int getColumns() const;
+
+		/**
+		 * Gets number of grid cells along Z.
+		 */
+		int getRows() const;
+
+	private:
+		float _width; // Grid width (along X)
+		float _depth; // Grid depth (along Z)
+		int _numColumns; // Number of cells along X
+		int _numRows; // Number of cells along Z
+
+		void initializeData() override;
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
+	};
+
+} // namespace static_meshes_3D
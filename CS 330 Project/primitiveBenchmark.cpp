@@ -0,0 +1,90 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <functional>
+#include <vector>
+
+// Project
+#include "primitiveBenchmark.h"
+#include "box.h"
+#include "planeGrid.h"
+#include "uvSphere.h"
+#include "cone.h"
+#include "cylinder.h"
+#include "torus.h"
+#include "capsule.h"
+
+namespace {
+
+using static_meshes_3D::IndexedMesh3D;
+
+const int VERTEX_COUNTS[] = { 10000, 100000, 1000000, 4000000 }; // Approximate sizes every primitive is built at
+const int NUM_BOXES = 1000; // Boxes are tiny, so many of them are built instead
+
+/**
+ * Builds primitive with about given number of vertices.
+ */
+typedef std::function<std::unique_ptr<IndexedMesh3D>(int numVertices)> PrimitiveFactory;
+
+/**
+ * Gets number of segments of a square grid with about given number of vertices.
+ */
+int getGridSide(int numVertices)
+{
+    return static_cast<int>(std::sqrt(static_cast<double>(numVertices)));
+}
+
+double getMillisecondsSince(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void report(const char* name, int numVertices, int numIndices, double milliseconds)
+{
+    std::cout << "  " << std::left << std::setw(10) << name << std::right << std::setw(9) << numVertices << " vertices, "
+        << std::setw(9) << numIndices / 3 << " triangles: " << std::fixed << std::setprecision(2) << std::setw(9) << milliseconds << " ms, "
+        << std::setprecision(1) << numVertices / (milliseconds * 1.0e3) << " M vertices/s" << std::defaultfloat << std::endl;
+}
+
+} // namespace
+
+void benchmarkPrimitiveGeneration()
+{
+    using namespace static_meshes_3D;
+
+    const std::pair<const char*, PrimitiveFactory> primitives[] = {
+        { "plane", [](int n) { return std::unique_ptr<IndexedMesh3D>(new PlaneGrid(1.0f, 1.0f, getGridSide(n), getGridSide(n))); } },
+        { "sphere", [](int n) { return std::unique_ptr<IndexedMesh3D>(new UVSphere(1.0f, getGridSide(n * 2), getGridSide(n * 2) / 2)); } },
+        { "torus", [](int n) { return std::unique_ptr<IndexedMesh3D>(new Torus(1.0f, 0.25f, getGridSide(n * 4), getGridSide(n) / 2)); } },
+        { "capsule", [](int n) { return std::unique_ptr<IndexedMesh3D>(new Capsule(0.5f, 1.0f, getGridSide(n * 2), getGridSide(n * 2) / 4)); } },
+        { "cone", [](int n) { return std::unique_ptr<IndexedMesh3D>(new Cone(1.0f, 1.0f, n / 3)); } },
+        { "cylinder", [](int n) { return std::unique_ptr<IndexedMesh3D>(new Cylinder(1.0f, n / 4, 1.0f)); } }
+    };
+
+    std::cout << "Primitive generation benchmark (generation and upload):" << std::endl;
+    for (const auto& primitive : primitives)
+    {
+        for (const auto numVertices : VERTEX_COUNTS)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            const auto mesh = primitive.second(numVertices);
+            const auto milliseconds = getMillisecondsSince(startTime);
+            report(primitive.first, mesh->getNumVertices(), mesh->getNumIndices(), milliseconds);
+        }
+    }
+
+    // Boxes are only ever small, their cost is per mesh (buffers and VAO), not per vertex
+    {
+        std::vector<std::unique_ptr<Box>> boxes;
+        boxes.reserve(NUM_BOXES);
+        const auto startTime = std::chrono::steady_clock::now();
+        for (auto i = 0; i < NUM_BOXES; i++) {
+            boxes.emplace_back(new Box(1.0f, 1.0f, 1.0f));
+        }
+        const auto milliseconds = getMillisecondsSince(startTime);
+        report("boxes", boxes[0]->getNumVertices() * NUM_BOXES, boxes[0]->getNumIndices() * NUM_BOXES, milliseconds);
+    }
+}
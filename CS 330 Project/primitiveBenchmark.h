@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * Measures how fast the procedural primitives are generated. Builds every primitive at sizes from
+ * ten thousand to four million vertices, times construction (generation plus upload to the GPU)
+ * and prints time and vertex throughput of each. GL thread only.
+ */
+void benchmarkPrimitiveGeneration();
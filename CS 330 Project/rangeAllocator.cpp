@@ -0,0 +1,136 @@
+// STL
+#include <iterator>
+
+// Project
+#include "rangeAllocator.h"
+
+const size_t RangeAllocator::NO_RANGE = ~size_t(0);
+
+RangeAllocator::RangeAllocator(size_t capacity)
+{
+    reset(capacity);
+}
+
+size_t RangeAllocator::allocate(size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    const auto bestFit = _freeBySize.lower_bound(size);
+    if (bestFit == _freeBySize.end()) {
+        return NO_RANGE;
+    }
+
+    // Range is carved from the start of the block, the rest stays free
+    const auto offset = bestFit->second;
+    const auto blockSize = bestFit->first;
+    eraseFreeBlock(_freeByOffset.find(offset));
+    if (blockSize > size) {
+        insertFreeBlock(offset + size, blockSize - size);
+    }
+
+    return offset;
+}
+
+void RangeAllocator::free(size_t offset, size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+
+    // Merge with the free blocks right after and right before, if any
+    const auto next = _freeByOffset.lower_bound(offset);
+    if (next != _freeByOffset.begin())
+    {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            eraseFreeBlock(previous);
+        }
+    }
+    if (next != _freeByOffset.end() && next->first == offset + size)
+    {
+        size += next->second;
+        eraseFreeBlock(next);
+    }
+
+    insertFreeBlock(offset, size);
+}
+
+void RangeAllocator::grow(size_t newCapacity)
+{
+    if (newCapacity <= _capacity) {
+        return;
+    }
+
+    const auto oldCapacity = _capacity;
+    _capacity = newCapacity;
+    free(oldCapacity, newCapacity - oldCapacity);
+}
+
+void RangeAllocator::reset(size_t capacity)
+{
+    _freeByOffset.clear();
+    _freeBySize.clear();
+    _freeSize = 0;
+    _capacity = capacity;
+    if (capacity > 0) {
+        insertFreeBlock(0, capacity);
+    }
+}
+
+size_t RangeAllocator::getCapacity() const
+{
+    return _capacity;
+}
+
+size_t RangeAllocator::getFreeSize() const
+{
+    return _freeSize;
+}
+
+size_t RangeAllocator::getNumFreeBlocks() const
+{
+    return _freeByOffset.size();
+}
+
+size_t RangeAllocator::getLargestFreeBlock() const
+{
+    return _freeBySize.empty() ? 0 : _freeBySize.rbegin()->first;
+}
+
+bool RangeAllocator::isPacked() const
+{
+    if (_freeByOffset.empty()) {
+        return true;
+    }
+
+    const auto& block = *_freeByOffset.begin();
+    return _freeByOffset.size() == 1 && block.first + block.second == _capacity;
+}
+
+void RangeAllocator::insertFreeBlock(size_t offset, size_t size)
+{
+    _freeByOffset.emplace(offset, size);
+    _freeBySize.emplace(size, offset);
+    _freeSize += size;
+}
+
+void RangeAllocator::eraseFreeBlock(std::map<size_t, size_t>::iterator block)
+{
+    const auto sameSize = _freeBySize.equal_range(block->second);
+    for (auto it = sameSize.first; it != sameSize.second; ++it)
+    {
+        if (it->second == block->first)
+        {
+            _freeBySize.erase(it);
+            break;
+        }
+    }
+
+    _freeSize -= block->second;
+    _freeByOffset.erase(block);
+}
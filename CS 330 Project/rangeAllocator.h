@@ -0,0 +1,73 @@
+#pragma once
+// STL
+#include <map>
+#include <cstddef>
+
+/**
+ * Free-list allocator of ranges in [0, capacity), e.g. of vertices or indices in a shared buffer. Picks
+ * the smallest free block that fits (best fit) and merges freed ranges with their free neighbors, so that
+ * both allocating and freeing take logarithmic time. Only offsets are tracked, the memory is elsewhere.
+ */
+class RangeAllocator
+{
+public:
+    static const size_t NO_RANGE; // Offset returned when nothing fits
+
+    explicit RangeAllocator(size_t capacity = 0);
+
+    /**
+     * Allocates range of given size.
+     *
+     * @return Offset of the range, or NO_RANGE if no free block is big enough (0 for empty ranges).
+     */
+    size_t allocate(size_t size);
+
+    /**
+     * Frees range returned by allocate.
+     */
+    void free(size_t offset, size_t size);
+
+    /**
+     * Extends the capacity, the new space at the end becomes free.
+     */
+    void grow(size_t newCapacity);
+
+    /**
+     * Frees everything and sets new capacity.
+     */
+    void reset(size_t capacity);
+
+    /**
+     * Gets size of the managed space.
+     */
+    size_t getCapacity() const;
+
+    /**
+     * Gets total size of all free blocks.
+     */
+    size_t getFreeSize() const;
+
+    /**
+     * Gets number of free blocks (1 or less means there is no fragmentation).
+     */
+    size_t getNumFreeBlocks() const;
+
+    /**
+     * Gets size of the biggest free block, the biggest range that can be allocated.
+     */
+    size_t getLargestFreeBlock() const;
+
+    /**
+     * Checks, if all free space is one block at the end (or there is none), i.e. the ranges are packed.
+     */
+    bool isPacked() const;
+
+private:
+    std::map<size_t, size_t> _freeByOffset; // Offset -> size of every free block
+    std::multimap<size_t, size_t> _freeBySize; // Size -> offset of every free block
+    size_t _capacity = 0; // Size of the managed space
+    size_t _freeSize = 0; // Total size of the free blocks
+
+    void insertFreeBlock(size_t offset, size_t size);
+    void eraseFreeBlock(std::map<size_t, size_t>::iterator block);
+};
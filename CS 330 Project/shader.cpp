@@ -11,16 +11,13 @@ using namespace std;
 #include <stdlib.h>
 #include <string.h>
 
-#include <GL/glew.h>
+#include <glad/glad.h>
 
 #include "shader.hpp"
+#include "shaderCache.h"
 
 GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
 
-	// Create the shaders
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
 	// Read the Vertex Shader code from the file
 	std::string VertexShaderCode;
 	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
@@ -45,6 +42,18 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
 		FragmentShaderStream.close();
 	}
 
+	// Try the program binary cache before compiling anything
+	uint64_t ProgramKey = shader_cache::computeProgramKey({ VertexShaderCode, FragmentShaderCode }, "");
+	GLuint CachedProgramID = shader_cache::loadProgramBinary(ProgramKey);
+	if (CachedProgramID != 0) {
+		printf("Loaded program %s + %s from binary cache\n", vertex_file_path, fragment_file_path);
+		return CachedProgramID;
+	}
+
+	// Create the shaders
+	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+
 	GLint Result = GL_FALSE;
 	int InfoLogLength;
 
@@ -86,6 +95,7 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
 	// Link the program
 	printf("Linking program\n");
 	GLuint ProgramID = glCreateProgram();
+	shader_cache::prepareProgramForBinaryRetrieval(ProgramID);
 	glAttachShader(ProgramID, VertexShaderID);
 	glAttachShader(ProgramID, FragmentShaderID);
 	glLinkProgram(ProgramID);
@@ -98,6 +108,9 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
 		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
 		printf("%s\n", &ProgramErrorMessage[0]);
 	}
+	if ( Result == GL_TRUE ){
+		shader_cache::storeProgramBinary(ProgramKey, ProgramID);
+	}
 
 	
 	glDetachShader(ProgramID, VertexShaderID);
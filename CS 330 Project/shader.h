@@ -10,15 +10,19 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+
+#include "shaderCache.h"
 
 class Shader
 {
 public:
 	unsigned int ID;
-	// constructor generates the shader on the fly
+	// constructor generates the shader on the fly (or loads it from the program binary cache)
 	// ------------------------------------------------------------------------
-	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
+	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr, const std::string& defines = "")
 	{
+		const auto startTime = std::chrono::steady_clock::now();
 		// 1. retrieve the vertex/fragment source code from filePath
 		std::string vertexCode;
 		std::string fragmentCode;
@@ -59,9 +63,21 @@ public:
 		{
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
 		}
+		vertexCode = shader_cache::insertDefines(vertexCode, defines);
+		fragmentCode = shader_cache::insertDefines(fragmentCode, defines);
+		if (geometryPath != nullptr)
+			geometryCode = shader_cache::insertDefines(geometryCode, defines);
+		// 2. try the program binary cache first, it is much faster than compiling
+		const auto programKey = shader_cache::computeProgramKey({ vertexCode, fragmentCode, geometryCode }, defines);
+		ID = shader_cache::loadProgramBinary(programKey);
+		if (ID != 0)
+		{
+			reportLoadTime(vertexPath, fragmentPath, "loaded from program binary cache", startTime);
+			return;
+		}
 		const char* vShaderCode = vertexCode.c_str();
 		const char * fShaderCode = fragmentCode.c_str();
-		// 2. compile shaders
+		// 3. compile shaders
 		unsigned int vertex, fragment;
 		// vertex shader
 		vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -85,18 +101,26 @@ public:
 		}
 		// shader Program
 		ID = glCreateProgram();
+		shader_cache::prepareProgramForBinaryRetrieval(ID);
 		glAttachShader(ID, vertex);
 		glAttachShader(ID, fragment);
 		if (geometryPath != nullptr)
 			glAttachShader(ID, geometry);
 		glLinkProgram(ID);
-		checkCompileErrors(ID, "PROGRAM");
+		if (checkCompileErrors(ID, "PROGRAM"))
+			shader_cache::storeProgramBinary(programKey, ID);
 		// delete the shaders as they're linked into our program now and no longer necessery
 		glDeleteShader(vertex);
 		glDeleteShader(fragment);
 		if (geometryPath != nullptr)
 			glDeleteShader(geometry);
 
+		reportLoadTime(vertexPath, fragmentPath, "compiled from source", startTime);
+	}
+	// wraps already linked program (e.g. one finished by ShaderCompiler)
+	// ------------------------------------------------------------------------
+	explicit Shader(unsigned int programID) : ID(programID)
+	{
 	}
 	// activate the shader
 	// ------------------------------------------------------------------------
@@ -164,9 +188,17 @@ public:
 	}
 
 private:
+	// prints how long it took to get the program ready (startup benchmark)
+	// ------------------------------------------------------------------------
+	void reportLoadTime(const char* vertexPath, const char* fragmentPath, const char* how, std::chrono::steady_clock::time_point startTime) const
+	{
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+		std::cout << "Shader program " << vertexPath << " + " << fragmentPath << " " << how << " in " << elapsed.count() << " ms" << std::endl;
+	}
 	// utility function for checking shader compilation/linking errors.
+	// returns true, if compilation / linking was successful
 	// ------------------------------------------------------------------------
-	void checkCompileErrors(GLuint shader, std::string type)
+	bool checkCompileErrors(GLuint shader, std::string type)
 	{
 		GLint success;
 		GLchar infoLog[1024];
@@ -188,6 +220,7 @@ private:
 				std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
 			}
 		}
+		return success == GL_TRUE;
 	}
 };
 #endif
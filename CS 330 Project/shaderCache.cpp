@@ -0,0 +1,249 @@
+// STL
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Project
+#include "shaderCache.h"
+
+namespace shader_cache {
+
+namespace {
+
+const uint32_t BINARY_FILE_MAGIC = 0x4E494250; // "PBIN"
+const uint32_t BINARY_FILE_VERSION = 1;
+
+/**
+ * Header written in front of every cached program binary.
+ */
+struct BinaryFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+};
+
+std::string cacheDirectory = "shadercache";
+bool isCacheDirectoryCreated = false;
+
+// 64-bit FNV-1a, good enough to tell shader sources apart
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t length)
+{
+    const auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t hashString(uint64_t hash, const std::string& text)
+{
+    // Hash length as well, so that ("ab", "c") and ("a", "bc") give different keys
+    const uint64_t length = text.size();
+    hash = hashBytes(hash, &length, sizeof(length));
+    return hashBytes(hash, text.data(), text.size());
+}
+
+std::string glString(GLenum name)
+{
+    const auto value = reinterpret_cast<const char*>(glGetString(name));
+    return value != nullptr ? value : "";
+}
+
+std::string getBinaryFilePath(uint64_t key)
+{
+    std::ostringstream path;
+    path << cacheDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".progbin";
+    return path.str();
+}
+
+void ensureCacheDirectoryExists()
+{
+    if (isCacheDirectoryCreated) {
+        return;
+    }
+
+    // Fails harmlessly, if the directory exists already
+#ifdef _WIN32
+    _mkdir(cacheDirectory.c_str());
+#else
+    mkdir(cacheDirectory.c_str(), 0755);
+#endif
+    isCacheDirectoryCreated = true;
+}
+
+} // namespace
+
+std::string insertDefines(const std::string& source, const std::string& defines)
+{
+    if (defines.empty()) {
+        return source;
+    }
+
+    const auto versionPos = source.find("#version");
+    if (versionPos == std::string::npos) {
+        return defines + source;
+    }
+
+    const auto lineEnd = source.find('\n', versionPos);
+    if (lineEnd == std::string::npos) {
+        return source + "\n" + defines;
+    }
+
+    auto result = source.substr(0, lineEnd + 1);
+    result += defines;
+    if (defines.back() != '\n') {
+        result += '\n';
+    }
+    result += source.substr(lineEnd + 1);
+    return result;
+}
+
+bool isProgramBinarySupported()
+{
+    static int isSupported = -1;
+    if (isSupported == -1)
+    {
+        GLint numFormats = 0;
+        if (GLAD_GL_VERSION_4_1) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        }
+        isSupported = numFormats > 0 ? 1 : 0;
+    }
+
+    return isSupported == 1;
+}
+
+void setCacheDirectory(const std::string& directory)
+{
+    cacheDirectory = directory;
+    isCacheDirectoryCreated = false;
+}
+
+uint64_t computeProgramKey(const std::vector<std::string>& sources, const std::string& defines)
+{
+    auto hash = FNV_OFFSET_BASIS;
+    for (const auto& source : sources) {
+        hash = hashString(hash, source);
+    }
+    hash = hashString(hash, defines);
+
+    // Binaries are only valid for the exact same driver
+    hash = hashString(hash, glString(GL_VENDOR));
+    hash = hashString(hash, glString(GL_RENDERER));
+    hash = hashString(hash, glString(GL_VERSION));
+
+    return hash;
+}
+
+void prepareProgramForBinaryRetrieval(GLuint program)
+{
+    if (isProgramBinarySupported()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+GLuint loadProgramBinary(uint64_t key)
+{
+    if (!isProgramBinarySupported()) {
+        return 0;
+    }
+
+    const auto path = getBinaryFilePath(key);
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    // The header is checked before anything is allocated, so that a corrupted length can't ask for gigabytes
+    const auto fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+    BinaryFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    auto isFileValid = file && header.magic == BINARY_FILE_MAGIC && header.version == BINARY_FILE_VERSION && header.key == key
+        && header.binaryLength == fileSize - sizeof(header);
+    std::vector<char> binary;
+    if (isFileValid)
+    {
+        binary.resize(header.binaryLength);
+        file.read(binary.data(), binary.size());
+        isFileValid = static_cast<bool>(file);
+    }
+    file.close();
+
+    if (!isFileValid)
+    {
+        std::cerr << "Program binary " << path << " is corrupted, removing it" << std::endl;
+        std::remove(path.c_str());
+        return 0;
+    }
+
+    const auto program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // Driver has changed in a way the key did not catch, fall back to compilation
+        std::cout << "Program binary " << path << " rejected by the driver, recompiling from source" << std::endl;
+        glDeleteProgram(program);
+        std::remove(path.c_str());
+        return 0;
+    }
+
+    return program;
+}
+
+void storeProgramBinary(uint64_t key, GLuint program)
+{
+    if (!isProgramBinarySupported()) {
+        return;
+    }
+
+    GLint binaryLength = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(binaryLength);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, binaryLength, nullptr, &binaryFormat, binary.data());
+
+    ensureCacheDirectoryExists();
+    const auto path = getBinaryFilePath(key);
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Could not write program binary " << path << std::endl;
+        return;
+    }
+
+    BinaryFileHeader header;
+    header.magic = BINARY_FILE_MAGIC;
+    header.version = BINARY_FILE_VERSION;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binaryLength = static_cast<uint32_t>(binary.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), binary.size());
+}
+
+} // namespace shader_cache
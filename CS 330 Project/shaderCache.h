@@ -0,0 +1,67 @@
+#pragma once
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+namespace shader_cache {
+
+/**
+ * Inserts preprocessor defines into shader source, right after the #version line
+ * (GLSL requires #version to be the very first statement).
+ *
+ * @param source   Shader source code
+ * @param defines  Define lines to insert (e.g. "#define NR_POINT_LIGHTS 4\n"), may be empty
+ *
+ * @return Shader source with defines inserted.
+ */
+std::string insertDefines(const std::string& source, const std::string& defines);
+
+/**
+ * Checks, if the current context supports retrieving and loading program binaries
+ * (OpenGL 4.1 or later with at least one binary format).
+ */
+bool isProgramBinarySupported();
+
+/**
+ * Sets the directory used to store program binaries (default is "shadercache").
+ */
+void setCacheDirectory(const std::string& directory);
+
+/**
+ * Computes cache key of a program. The key is a hash of all shader sources, defines
+ * and the driver identity (vendor, renderer and version strings), so that a driver
+ * update automatically invalidates all cached binaries.
+ *
+ * @param sources  Source code of all shader stages of the program
+ * @param defines  Defines the program is compiled with
+ */
+uint64_t computeProgramKey(const std::vector<std::string>& sources, const std::string& defines);
+
+/**
+ * Marks program binary as retrievable. Must be called before linking the program,
+ * otherwise the driver may not keep the binary around for storeProgramBinary.
+ */
+void prepareProgramForBinaryRetrieval(GLuint program);
+
+/**
+ * Tries to create a linked program from a cached binary.
+ *
+ * @param key  Program key (see computeProgramKey)
+ *
+ * @return Linked program ID, or 0 if there is no cached binary or the driver has rejected it.
+ *         Rejected binaries are removed from the cache, so the caller just compiles from source.
+ */
+GLuint loadProgramBinary(uint64_t key);
+
+/**
+ * Stores binary of a successfully linked program to the cache.
+ *
+ * @param key      Program key (see computeProgramKey)
+ * @param program  Linked program ID
+ */
+void storeProgramBinary(uint64_t key, GLuint program);
+
+} // namespace shader_cache
@@ -0,0 +1,286 @@
+// STL
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+// Project
+#include "shaderCompiler.h"
+#include "shaderCache.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_PRIVATE)(GLuint count);
+
+bool readShaderFile(const char* path, std::string& code)
+{
+    std::ifstream file(path, std::ios::in);
+    if (!file.is_open())
+    {
+        std::cerr << "Could not open shader file " << path << std::endl;
+        return false;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    code = stream.str();
+    return true;
+}
+
+bool isExtensionSupported(const char* extensionName)
+{
+    GLint numExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+    for (GLint i = 0; i < numExtensions; i++)
+    {
+        const auto name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name != nullptr && strcmp(name, extensionName) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void printInfoLog(GLuint objectID, bool isProgram, const std::string& name)
+{
+    GLint infoLogLength = 0;
+    if (isProgram) {
+        glGetProgramiv(objectID, GL_INFO_LOG_LENGTH, &infoLogLength);
+    }
+    else {
+        glGetShaderiv(objectID, GL_INFO_LOG_LENGTH, &infoLogLength);
+    }
+    if (infoLogLength <= 0) {
+        return;
+    }
+
+    std::vector<char> infoLog(infoLogLength + 1);
+    if (isProgram) {
+        glGetProgramInfoLog(objectID, infoLogLength, nullptr, infoLog.data());
+    }
+    else {
+        glGetShaderInfoLog(objectID, infoLogLength, nullptr, infoLog.data());
+    }
+    std::cerr << (isProgram ? "Linking " : "Compiling ") << name << " failed:\n" << infoLog.data() << std::endl;
+}
+
+} // namespace
+
+ShaderCompiler::ShaderCompiler(GLADloadproc loadProc)
+{
+    _hasParallelCompile = isExtensionSupported("GL_KHR_parallel_shader_compile") || isExtensionSupported("GL_ARB_parallel_shader_compile");
+    if (_hasParallelCompile && loadProc != nullptr)
+    {
+        // Let the driver use as many compiler threads as it wants
+        auto maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_PRIVATE>(loadProc("glMaxShaderCompilerThreadsKHR"));
+        if (maxShaderCompilerThreads == nullptr) {
+            maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_PRIVATE>(loadProc("glMaxShaderCompilerThreadsARB"));
+        }
+        if (maxShaderCompilerThreads != nullptr) {
+            maxShaderCompilerThreads(0xFFFFFFFF);
+        }
+    }
+
+    std::cout << "Shader compiler created, parallel compilation " << (_hasParallelCompile ? "available" : "not available") << std::endl;
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+    for (auto& program : _programs)
+    {
+        for (const auto shaderID : program.shaderIDs) {
+            glDeleteShader(shaderID);
+        }
+        if (program.programID != 0) {
+            glDeleteProgram(program.programID);
+        }
+    }
+}
+
+ShaderCompiler::ProgramHandle ShaderCompiler::submit(const char* vertexPath, const char* fragmentPath, const char* geometryPath, const std::string& defines)
+{
+    SubmittedProgram program;
+    program.name = std::string(vertexPath) + " + " + fragmentPath;
+    program.submitTime = std::chrono::steady_clock::now();
+    const auto handle = static_cast<ProgramHandle>(_programs.size());
+
+    // Read all sources first, nothing is sent to the driver if a file is missing
+    std::vector<std::string> sources(geometryPath != nullptr ? 3 : 2);
+    const char* paths[] = { vertexPath, fragmentPath, geometryPath };
+    const GLenum shaderTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        if (!readShaderFile(paths[i], sources[i]))
+        {
+            program.state = ProgramState::Failed;
+            _programs.push_back(program);
+            return handle;
+        }
+        sources[i] = shader_cache::insertDefines(sources[i], defines);
+    }
+
+    program.cacheKey = shader_cache::computeProgramKey(sources, defines);
+    program.programID = shader_cache::loadProgramBinary(program.cacheKey);
+    if (program.programID != 0)
+    {
+        program.state = ProgramState::Ready;
+        std::cout << "Shader program " << program.name << " loaded from program binary cache" << std::endl;
+        _programs.push_back(program);
+        return handle;
+    }
+
+    // Kick off compilation and linking without asking for any status
+    program.programID = glCreateProgram();
+    shader_cache::prepareProgramForBinaryRetrieval(program.programID);
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        const auto shaderID = glCreateShader(shaderTypes[i]);
+        const char* code = sources[i].c_str();
+        glShaderSource(shaderID, 1, &code, nullptr);
+        glCompileShader(shaderID);
+        glAttachShader(program.programID, shaderID);
+        program.shaderIDs.push_back(shaderID);
+    }
+    glLinkProgram(program.programID);
+
+    _programs.push_back(program);
+    return handle;
+}
+
+void ShaderCompiler::poll()
+{
+    auto hasBlockingFinishHappened = false;
+    for (auto& program : _programs)
+    {
+        if (program.state != ProgramState::Compiling) {
+            continue;
+        }
+
+        if (_hasParallelCompile)
+        {
+            if (isCompletionReported(program)) {
+                finishProgram(program);
+            }
+        }
+        else if (!hasBlockingFinishHappened)
+        {
+            // Status queries block without the extension, so finish only one program per call
+            finishProgram(program);
+            hasBlockingFinishHappened = true;
+        }
+    }
+}
+
+void ShaderCompiler::waitFor(ProgramHandle handle)
+{
+    if (handle < 0 || handle >= static_cast<ProgramHandle>(_programs.size())) {
+        return;
+    }
+
+    auto& program = _programs[handle];
+    if (program.state == ProgramState::Compiling) {
+        finishProgram(program);
+    }
+}
+
+void ShaderCompiler::waitForAll()
+{
+    for (auto handle = 0; handle < static_cast<ProgramHandle>(_programs.size()); handle++) {
+        waitFor(handle);
+    }
+}
+
+bool ShaderCompiler::isReady(ProgramHandle handle) const
+{
+    return handle >= 0 && handle < static_cast<ProgramHandle>(_programs.size()) && _programs[handle].state == ProgramState::Ready;
+}
+
+bool ShaderCompiler::hasFailed(ProgramHandle handle) const
+{
+    return handle >= 0 && handle < static_cast<ProgramHandle>(_programs.size()) && _programs[handle].state == ProgramState::Failed;
+}
+
+GLuint ShaderCompiler::getProgramID(ProgramHandle handle) const
+{
+    return isReady(handle) ? _programs[handle].programID : 0;
+}
+
+GLuint ShaderCompiler::getProgramIDOrFallback(ProgramHandle handle, ProgramHandle fallbackHandle) const
+{
+    return isReady(handle) ? getProgramID(handle) : getProgramID(fallbackHandle);
+}
+
+int ShaderCompiler::getNumPending() const
+{
+    auto result = 0;
+    for (const auto& program : _programs)
+    {
+        if (program.state == ProgramState::Compiling) {
+            result++;
+        }
+    }
+
+    return result;
+}
+
+bool ShaderCompiler::hasParallelCompile() const
+{
+    return _hasParallelCompile;
+}
+
+bool ShaderCompiler::isCompletionReported(const SubmittedProgram& program) const
+{
+    // Link completion implies the attached shaders are done as well
+    GLint isComplete = GL_FALSE;
+    glGetProgramiv(program.programID, GL_COMPLETION_STATUS_KHR, &isComplete);
+    return isComplete == GL_TRUE;
+}
+
+void ShaderCompiler::finishProgram(SubmittedProgram& program)
+{
+    auto success = true;
+    for (const auto shaderID : program.shaderIDs)
+    {
+        GLint isCompiled = GL_FALSE;
+        glGetShaderiv(shaderID, GL_COMPILE_STATUS, &isCompiled);
+        if (!isCompiled)
+        {
+            printInfoLog(shaderID, false, program.name);
+            success = false;
+        }
+    }
+
+    GLint isLinked = GL_FALSE;
+    glGetProgramiv(program.programID, GL_LINK_STATUS, &isLinked);
+    if (success && !isLinked)
+    {
+        printInfoLog(program.programID, true, program.name);
+        success = false;
+    }
+
+    for (const auto shaderID : program.shaderIDs)
+    {
+        glDetachShader(program.programID, shaderID);
+        glDeleteShader(shaderID);
+    }
+    program.shaderIDs.clear();
+
+    if (!success)
+    {
+        glDeleteProgram(program.programID);
+        program.programID = 0;
+        program.state = ProgramState::Failed;
+        return;
+    }
+
+    shader_cache::storeProgramBinary(program.cacheKey, program.programID);
+    program.state = ProgramState::Ready;
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - program.submitTime;
+    std::cout << "Shader program " << program.name << " ready " << elapsed.count() << " ms after submission" << std::endl;
+}
@@ -0,0 +1,120 @@
+#pragma once
+// STL
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+/**
+ * Compilation front end that submits all shader programs up front and then only polls
+ * their status, instead of compiling and linking them one after another. Querying
+ * GL_COMPILE_STATUS right after glCompileShader forces the driver to finish that shader
+ * before anything else can happen, so here no status is queried until the program is done.
+ *
+ * With GL_KHR_parallel_shader_compile the driver compiles on its own threads and
+ * completion is polled without blocking. Without the extension at most one program
+ * is finished per poll() call, so the stall is spread across frames.
+ */
+class ShaderCompiler
+{
+public:
+    typedef int ProgramHandle;
+
+    /**
+     * Creates the compiler.
+     *
+     * @param loadProc  Optional GL function loader, used to raise the driver compiler thread
+     *                  count via glMaxShaderCompilerThreadsKHR (not part of the core loader)
+     */
+    explicit ShaderCompiler(GLADloadproc loadProc = nullptr);
+
+    /**
+     * Deletes all submitted programs (compiler owns them, so it must outlive their use).
+     */
+    ~ShaderCompiler();
+
+    /**
+     * Submits program for compilation and returns immediately. Programs found in
+     * the program binary cache are ready right away.
+     *
+     * @param vertexPath    Path to vertex shader source
+     * @param fragmentPath  Path to fragment shader source
+     * @param geometryPath  Optional path to geometry shader source
+     * @param defines       Define lines inserted after the #version line
+     *
+     * @return Handle used to query the program.
+     */
+    ProgramHandle submit(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr, const std::string& defines = "");
+
+    /**
+     * Finishes programs whose compilation has completed (never blocks when the
+     * parallel compile extension is available). Call once per frame.
+     */
+    void poll();
+
+    /**
+     * Blocks until given program is finished (ready or failed).
+     */
+    void waitFor(ProgramHandle handle);
+
+    /**
+     * Blocks until all submitted programs are finished.
+     */
+    void waitForAll();
+
+    /**
+     * Checks, if program is linked and can be used for drawing.
+     */
+    bool isReady(ProgramHandle handle) const;
+
+    /**
+     * Checks, if program has failed to compile or link.
+     */
+    bool hasFailed(ProgramHandle handle) const;
+
+    /**
+     * Gets OpenGL program ID, or 0 if the program is not ready yet.
+     */
+    GLuint getProgramID(ProgramHandle handle) const;
+
+    /**
+     * Gets program ID if the program is ready, otherwise ID of the fallback program.
+     */
+    GLuint getProgramIDOrFallback(ProgramHandle handle, ProgramHandle fallbackHandle) const;
+
+    /**
+     * Gets number of programs still being compiled.
+     */
+    int getNumPending() const;
+
+    /**
+     * Checks, if the driver supports GL_KHR_parallel_shader_compile.
+     */
+    bool hasParallelCompile() const;
+
+private:
+    enum class ProgramState
+    {
+        Compiling,
+        Ready,
+        Failed
+    };
+
+    struct SubmittedProgram
+    {
+        std::string name; // Vertex + fragment shader paths, used in log messages
+        GLuint programID = 0;
+        std::vector<GLuint> shaderIDs; // Attached shaders, deleted once the program is finished
+        uint64_t cacheKey = 0;
+        ProgramState state = ProgramState::Compiling;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
+    std::vector<SubmittedProgram> _programs; // All submitted programs, handle is index to this vector
+    bool _hasParallelCompile = false; // Flag telling, if GL_KHR_parallel_shader_compile is present
+
+    bool isCompletionReported(const SubmittedProgram& program) const;
+    void finishProgram(SubmittedProgram& program);
+};
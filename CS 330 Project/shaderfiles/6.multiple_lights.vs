@@ -1,11 +1,39 @@
 #version 330 core
+#ifdef QUANTIZED_VERTICES
+// quantized meshes: positions and texture coordinates normalized to their bounds, octahedral normals,
+// tangents in GL_INT_2_10_10_10_REV with the bitangent sign in w
+layout (location = 0) in vec3 aQuantizedPos;
+layout (location = 1) in vec2 aOctahedralNormal;
+layout (location = 2) in vec2 aQuantizedTexCoords;
+layout (location = 3) in vec4 aPackedTangent;
+
+uniform vec3 positionOrigin;
+uniform vec3 positionScale;
+uniform vec2 texCoordOrigin;
+uniform vec2 texCoordScale;
+
+// unfolds the lower half of the octahedron and projects back onto the unit sphere
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0);
+    direction.xy += vec2(direction.x >= 0.0 ? -fold : fold, direction.y >= 0.0 ? -fold : fold);
+    return normalize(direction);
+}
+#else
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+#endif
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+// tangent frame for normal mapping (zero for meshes without tangents)
+out vec3 Tangent;
+out vec3 Bitangent;
 
 uniform mat4 model;
 uniform mat4 view;
@@ -13,9 +41,19 @@ uniform mat4 projection;
 
 void main()
 {
+#ifdef QUANTIZED_VERTICES
+    vec3 aPos = positionOrigin + aQuantizedPos * positionScale;
+    vec3 aNormal = decodeOctahedral(aOctahedralNormal);
+    vec2 aTexCoords = texCoordOrigin + aQuantizedTexCoords * texCoordScale;
+    // only the bitangent's handedness is stored, the bitangent itself is rebuilt from normal and tangent
+    vec3 aTangent = aPackedTangent.xyz;
+    vec3 aBitangent = cross(aNormal, aTangent) * aPackedTangent.w;
+#endif
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;  
     TexCoords = aTexCoords;
+    Tangent = mat3(model) * aTangent;
+    Bitangent = mat3(model) * aBitangent;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 330 core
+out vec4 FragColor;
+
+// Unlit preview used while the real programs are still compiling
+struct Material {
+#ifdef MATERIAL_ATLAS
+    sampler2DArray diffuse;
+    int layer;
+#else
+    sampler2D diffuse;
+#endif
+};
+
+in vec2 TexCoords;
+
+uniform Material material;
+
+void main()
+{
+#ifdef MATERIAL_ATLAS
+    FragColor = vec4(texture(material.diffuse, vec3(TexCoords, material.layer)).rgb, 1.0);
+#else
+    FragColor = vec4(texture(material.diffuse, TexCoords).rgb, 1.0);
+#endif
+}
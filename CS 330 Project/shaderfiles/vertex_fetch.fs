@@ -0,0 +1,9 @@
+#version 330 core
+in float Shade;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(Shade);
+}
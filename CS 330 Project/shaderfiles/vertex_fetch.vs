@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+// ranges of quantized meshes (identity for float ones), quantized normals are fetched but left octahedral
+uniform vec3 positionOrigin;
+uniform vec3 positionScale;
+uniform vec2 texCoordOrigin;
+uniform vec2 texCoordScale;
+
+out float Shade;
+
+void main()
+{
+    // every attribute feeds the output, so the driver can't skip fetching any of them
+    vec3 position = positionOrigin + aPos * positionScale;
+    vec2 texCoords = texCoordOrigin + aTexCoords * texCoordScale;
+    Shade = dot(aNormal, vec3(texCoords, 1.0));
+    gl_Position = vec4(position * 0.001, 1.0);
+}
@@ -0,0 +1,48 @@
+// STL
+#include <cmath>
+
+// Project
+#include "sineCosineTable.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+const int EXACT_VALUE_INTERVAL = 64; // Steps between exactly computed values, bounds the rounding error of the recurrence
+
+} // namespace
+
+SineCosineTable computeSineCosineTable(int count, float angleStep, float startAngle)
+{
+    SineCosineTable result;
+    result.sines.resize(count);
+    result.cosines.resize(count);
+
+    const auto stepSine = std::sin(static_cast<double>(angleStep));
+    const auto stepCosine = std::cos(static_cast<double>(angleStep));
+    auto sine = 0.0;
+    auto cosine = 1.0;
+    for (auto i = 0; i < count; i++)
+    {
+        if (i % EXACT_VALUE_INTERVAL == 0)
+        {
+            const auto angle = static_cast<double>(startAngle) + static_cast<double>(angleStep) * i;
+            sine = std::sin(angle);
+            cosine = std::cos(angle);
+        }
+        else
+        {
+            // Angle addition: rotate (cos, sin) by the step
+            const auto nextSine = sine * stepCosine + cosine * stepSine;
+            cosine = cosine * stepCosine - sine * stepSine;
+            sine = nextSine;
+        }
+
+        result.sines[i] = static_cast<float>(sine);
+        result.cosines[i] = static_cast<float>(cosine);
+    }
+
+    return result;
+}
+
+} // namespace static_meshes_3D
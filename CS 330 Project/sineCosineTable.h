@@ -0,0 +1,24 @@
+#pragma once
+// STL
+#include <vector>
+
+namespace static_meshes_3D {
+
+/**
+ * Sines and cosines of evenly spaced angles, as procedural meshes need them for every ring of vertices.
+ */
+struct SineCosineTable
+{
+	std::vector<float> sines; // Sine of every angle
+	std::vector<float> cosines; // Cosine of every angle
+};
+
+/**
+ * Computes sines and cosines of angles startAngle + i * angleStep for i in [0, count). Consecutive
+ * values come from rotating the previous ones by the step (two multiply-adds instead of a sin and a cos),
+ * in double precision and restarted from exact values every few dozen steps, so that they stay
+ * accurate to float precision however long the table is.
+ */
+SineCosineTable computeSineCosineTable(int count, float angleStep, float startAngle = 0.0f);
+
+} // namespace static_meshes_3D
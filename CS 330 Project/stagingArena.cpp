@@ -0,0 +1,164 @@
+// STL
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+// Project
+#include "stagingArena.h"
+
+namespace {
+
+const size_t MINIMUM_CAPACITY = 1024; // Arenas never grow from less, so that growing small arenas doesn't copy over and over
+const size_t MAX_POOLED_BYTES = 64 * 1024 * 1024; // Capacity the pool keeps at most, larger arenas are freed on recycling
+const size_t FILL_BLOCK_SIZE = 256; // Size of the block fillRepeated repeats values into
+
+/**
+ * Arenas waiting for reuse, guarded by a mutex, so that meshes may be staged on any thread.
+ */
+struct ArenaPool
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<StagingArena>> arenas;
+    size_t pooledBytes = 0; // Total capacity of the pooled arenas
+};
+
+ArenaPool& getArenaPool()
+{
+    static ArenaPool pool;
+    return pool;
+}
+
+} // namespace
+
+std::unique_ptr<StagingArena> StagingArena::acquire(size_t reserveSizeBytes)
+{
+    std::unique_ptr<StagingArena> result;
+    {
+        auto& pool = getArenaPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        // Among arenas big enough the smallest wastes least, among too small ones the biggest grows least
+        const auto isBetter = [reserveSizeBytes](const StagingArena& candidate, const StagingArena& best)
+        {
+            const auto candidateFits = candidate.getCapacity() >= reserveSizeBytes;
+            const auto bestFits = best.getCapacity() >= reserveSizeBytes;
+            if (candidateFits != bestFits) {
+                return candidateFits;
+            }
+
+            return candidateFits ? candidate.getCapacity() < best.getCapacity() : candidate.getCapacity() > best.getCapacity();
+        };
+
+        auto best = pool.arenas.end();
+        for (auto it = pool.arenas.begin(); it != pool.arenas.end(); ++it)
+        {
+            if (best == pool.arenas.end() || isBetter(**it, **best)) {
+                best = it;
+            }
+        }
+
+        if (best != pool.arenas.end())
+        {
+            result = std::move(*best);
+            pool.arenas.erase(best);
+            pool.pooledBytes -= result->getCapacity();
+        }
+    }
+
+    if (!result) {
+        result.reset(new StagingArena());
+    }
+    result->reserve(reserveSizeBytes);
+    return result;
+}
+
+void StagingArena::recycle(std::unique_ptr<StagingArena> arena)
+{
+    if (!arena || arena->getCapacity() == 0) {
+        return;
+    }
+
+    arena->rewind();
+    auto& pool = getArenaPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.pooledBytes + arena->getCapacity() <= MAX_POOLED_BYTES)
+    {
+        pool.pooledBytes += arena->getCapacity();
+        pool.arenas.push_back(std::move(arena));
+    }
+}
+
+unsigned char* StagingArena::allocate(size_t sizeBytes)
+{
+    if (_size + sizeBytes > _capacity) {
+        reserve(std::max(_size + sizeBytes, _capacity * 2));
+    }
+
+    const auto result = _data.get() + _size;
+    _size += sizeBytes;
+    return result;
+}
+
+void StagingArena::reserve(size_t capacityBytes)
+{
+    if (capacityBytes <= _capacity) {
+        return;
+    }
+
+    const auto newCapacity = std::max(capacityBytes, MINIMUM_CAPACITY);
+    std::unique_ptr<unsigned char[]> newData(new unsigned char[newCapacity]);
+    if (_size > 0) {
+        memcpy(newData.get(), _data.get(), _size);
+    }
+    _data = std::move(newData);
+    _capacity = newCapacity;
+}
+
+void StagingArena::rewind()
+{
+    _size = 0;
+}
+
+unsigned char* StagingArena::getData() const
+{
+    return _data.get();
+}
+
+size_t StagingArena::getSize() const
+{
+    return _size;
+}
+
+size_t StagingArena::getCapacity() const
+{
+    return _capacity;
+}
+
+void fillRepeated(unsigned char* target, const void* value, size_t valueSizeBytes, size_t count)
+{
+    if (count == 0 || valueSizeBytes == 0) {
+        return;
+    }
+    if (count == 1 || valueSizeBytes > FILL_BLOCK_SIZE / 2)
+    {
+        for (size_t i = 0; i < count; i++) {
+            memcpy(target + i * valueSizeBytes, value, valueSizeBytes);
+        }
+        return;
+    }
+
+    // Whole number of values in the block, so that consecutive blocks continue the pattern
+    unsigned char block[FILL_BLOCK_SIZE];
+    const auto valuesPerBlock = std::min(FILL_BLOCK_SIZE / valueSizeBytes, count);
+    for (size_t i = 0; i < valuesPerBlock; i++) {
+        memcpy(block + i * valueSizeBytes, value, valueSizeBytes);
+    }
+
+    const auto blockSizeBytes = valuesPerBlock * valueSizeBytes;
+    const auto totalBytes = count * valueSizeBytes;
+    size_t written = 0;
+    for (; written + blockSizeBytes <= totalBytes; written += blockSizeBytes) {
+        memcpy(target + written, block, blockSizeBytes);
+    }
+    memcpy(target + written, block, totalBytes - written);
+}
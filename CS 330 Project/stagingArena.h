@@ -0,0 +1,133 @@
+#pragma once
+// STL
+#include <memory>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * Reusable bump allocator for data assembled on the CPU before it goes to a GPU buffer. Allocations
+ * are contiguous, so that the whole arena can be uploaded with one call, and rewinding keeps the memory,
+ * so that the next mesh is staged without allocating. Arenas are pooled: acquire one for the time
+ * a buffer is assembled and recycle it right after the upload, then staging memory of many meshes
+ * built one after another peaks at the size of the largest one instead of adding up.
+ */
+class StagingArena
+{
+public:
+    StagingArena() = default;
+    StagingArena(const StagingArena&) = delete;
+    StagingArena& operator=(const StagingArena&) = delete;
+
+    /**
+     * Takes empty arena from the pool (preferably the smallest one big enough) and reserves given capacity in it.
+     */
+    static std::unique_ptr<StagingArena> acquire(size_t reserveSizeBytes = 0);
+
+    /**
+     * Returns arena to the pool for reuse. Arenas the pool has no room for are freed.
+     */
+    static void recycle(std::unique_ptr<StagingArena> arena);
+
+    /**
+     * Appends uninitialized bytes. Growing beyond the capacity moves the data, so pointers returned
+     * earlier are only valid until the next allocation that doesn't fit (reserve up front to avoid it).
+     *
+     * @return Pointer to the appended bytes.
+     */
+    unsigned char* allocate(size_t sizeBytes);
+
+    /**
+     * Makes sure that given total number of bytes fits without moving the data.
+     */
+    void reserve(size_t capacityBytes);
+
+    /**
+     * Forgets all allocations, keeping the memory.
+     */
+    void rewind();
+
+    /**
+     * Gets start of the allocated data.
+     */
+    unsigned char* getData() const;
+
+    /**
+     * Gets number of allocated bytes.
+     */
+    size_t getSize() const;
+
+    /**
+     * Gets number of bytes that fit without growing.
+     */
+    size_t getCapacity() const;
+
+private:
+    std::unique_ptr<unsigned char[]> _data; // Arena memory
+    size_t _capacity = 0; // Size of the memory in bytes
+    size_t _size = 0; // Number of allocated bytes
+};
+
+/**
+ * Fills memory with given value repeated count times. The value is repeated into a small block first,
+ * which is then copied as a whole, so the target is never read (it may be write-combined mapped memory).
+ */
+void fillRepeated(unsigned char* target, const void* value, size_t valueSizeBytes, size_t count);
+
+/**
+ * Typed view of staged bytes, for writing elements of trivially copyable type T. Elements are copied
+ * bytewise, so the bytes need not be aligned for T. Elements may be strided (e.g. one attribute of
+ * interleaved vertices), contiguous spans are filled in bulk.
+ */
+template<typename T>
+class StagingSpan
+{
+public:
+    StagingSpan(unsigned char* data, size_t size, size_t stride = sizeof(T))
+        : _data(data)
+        , _size(data != nullptr ? size : 0)
+        , _stride(stride) {}
+
+    /**
+     * Writes element at given index (ignored beyond the end).
+     */
+    void write(size_t index, const T& value)
+    {
+        if (index < _size) {
+            memcpy(_data + index * _stride, &value, sizeof(T));
+        }
+    }
+
+    /**
+     * Writes value to count elements starting at given index (clipped at the end).
+     */
+    void fill(size_t firstIndex, size_t count, const T& value)
+    {
+        if (firstIndex >= _size) {
+            return;
+        }
+
+        const auto clippedCount = count < _size - firstIndex ? count : _size - firstIndex;
+        if (_stride == sizeof(T)) {
+            fillRepeated(_data + firstIndex * sizeof(T), &value, sizeof(T), clippedCount);
+        }
+        else
+        {
+            for (size_t i = 0; i < clippedCount; i++) {
+                memcpy(_data + (firstIndex + i) * _stride, &value, sizeof(T));
+            }
+        }
+    }
+
+    /**
+     * Gets number of elements of the span.
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    unsigned char* _data; // First element
+    size_t _size; // Number of elements
+    size_t _stride; // Bytes between consecutive elements
+};
@@ -4,13 +4,15 @@
 namespace static_meshes_3D {
 
 const int StaticMesh3D::POSITION_ATTRIBUTE_INDEX           = 0;
-const int StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX = 1;
-const int StaticMesh3D::NORMAL_ATTRIBUTE_INDEX             = 2;
+const int StaticMesh3D::NORMAL_ATTRIBUTE_INDEX             = 1;
+const int StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX = 2;
 
-StaticMesh3D::StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals)
+StaticMesh3D::StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat)
     : _hasPositions(withPositions)
     , _hasTextureCoordinates(withTextureCoordinates)
-    , _hasNormals(withNormals) {}
+    , _hasNormals(withNormals)
+    , _vertexLayout(vertexLayout)
+    , _vertexFormat(vertexFormat) {}
 
 StaticMesh3D::~StaticMesh3D()
 {
@@ -25,6 +27,7 @@ void StaticMesh3D::deleteMesh()
 
     glDeleteVertexArrays(1, &_vao);
     _vbo.deleteVBO();
+    _indicesVbo.deleteVBO();
 
     _isInitialized = false;
 }
@@ -46,46 +49,153 @@ bool StaticMesh3D::hasNormals() const
 
 int StaticMesh3D::getVertexByteSize() const
 {
-    int result = 0;
+    size_t result = 0;
     if (hasPositions()) {
-        result += sizeof(glm::vec3);
+        result += getAttributeByteSize(POSITION_ATTRIBUTE_INDEX);
     }
     if (hasTextureCoordinates()) {
-        result += sizeof(glm::vec2);
+        result += getAttributeByteSize(TEXTURE_COORDINATE_ATTRIBUTE_INDEX);
     }
     if (hasNormals()) {
-        result += sizeof(glm::vec3);
+        result += getAttributeByteSize(NORMAL_ATTRIBUTE_INDEX);
     }
 
+    return static_cast<int>(result);
+}
+
+VertexLayout StaticMesh3D::getVertexLayout() const
+{
+    return _vertexLayout;
+}
+
+VertexFormat StaticMesh3D::getVertexFormat() const
+{
+    return _vertexFormat;
+}
+
+const QuantizationRange& StaticMesh3D::getPositionRange() const
+{
+    return _positionRange;
+}
+
+const QuantizationRange& StaticMesh3D::getTextureCoordinateRange() const
+{
+    return _textureCoordinateRange;
+}
+
+void StaticMesh3D::setQuantizationUniforms(GLuint programID) const
+{
+    glUniform3fv(glGetUniformLocation(programID, "positionOrigin"), 1, &_positionRange.origin[0]);
+    glUniform3fv(glGetUniformLocation(programID, "positionScale"), 1, &_positionRange.scale[0]);
+    glUniform2fv(glGetUniformLocation(programID, "texCoordOrigin"), 1, &_textureCoordinateRange.origin[0]);
+    glUniform2fv(glGetUniformLocation(programID, "texCoordScale"), 1, &_textureCoordinateRange.scale[0]);
+}
+
+VertexAttributePlacement StaticMesh3D::getAttributePlacement(int attributeIndex, int numVertices) const
+{
+    // Attributes come in the order of their indices, skipping the missing ones
+    VertexAttributePlacement result;
+    result.offset = 0;
+    for (auto i = 0; i < attributeIndex; i++)
+    {
+        if (hasAttribute(i)) {
+            result.offset += _vertexLayout == VertexLayout::Interleaved ? getAttributeByteSize(i) : getAttributeByteSize(i) * numVertices;
+        }
+    }
+    result.stride = _vertexLayout == VertexLayout::Interleaved ? getVertexByteSize() : getAttributeByteSize(attributeIndex);
+
     return result;
 }
 
-void StaticMesh3D::setVertexAttributesPointers(int numVertices)
+VertexFormatDescription StaticMesh3D::getVertexFormatDescription(int numVertices) const
 {
-    uint64_t offset = 0;
+    VertexFormatDescription result;
+    result.vertexByteSize = static_cast<size_t>(getVertexByteSize());
+    const auto isQuantized = _vertexFormat == VertexFormat::Quantized;
+    const auto addAttribute = [&](int attributeIndex, GLint numComponents, GLenum type, GLboolean isNormalized)
+    {
+        const auto placement = getAttributePlacement(attributeIndex, numVertices);
+        result.attributes.push_back(VertexAttributeDescription{ static_cast<GLuint>(attributeIndex), numComponents, type, isNormalized, placement.offset, placement.stride });
+    };
+
     if (hasPositions())
     {
-        glEnableVertexAttribArray(POSITION_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(POSITION_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(offset));
+        if (isQuantized) {
+            addAttribute(POSITION_ATTRIBUTE_INDEX, 3, GL_UNSIGNED_SHORT, GL_TRUE);
+        }
+        else {
+            addAttribute(POSITION_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE);
+        }
+    }
 
-        offset += sizeof(glm::vec3)*numVertices;
+    if (hasNormals())
+    {
+        if (isQuantized) {
+            // Octahedral encoding, the shader turns the two components back into a unit vector
+            addAttribute(NORMAL_ATTRIBUTE_INDEX, 2, GL_SHORT, GL_TRUE);
+        }
+        else {
+            addAttribute(NORMAL_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE);
+        }
     }
 
     if (hasTextureCoordinates())
     {
-        glEnableVertexAttribArray(TEXTURE_COORDINATE_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(TEXTURE_COORDINATE_ATTRIBUTE_INDEX, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(offset));
+        if (isQuantized) {
+            addAttribute(TEXTURE_COORDINATE_ATTRIBUTE_INDEX, 2, GL_UNSIGNED_SHORT, GL_TRUE);
+        }
+        else {
+            addAttribute(TEXTURE_COORDINATE_ATTRIBUTE_INDEX, 2, GL_FLOAT, GL_FALSE);
+        }
+    }
 
-        offset += sizeof(glm::vec2)*numVertices;
+    return result;
+}
+
+void StaticMesh3D::setVertexAttributesPointers(int numVertices)
+{
+    setVertexAttributePointers(getVertexFormatDescription(numVertices));
+}
+
+void StaticMesh3D::setPositionBounds(const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    // Float positions are written as they are, their range stays identity
+    if (_vertexFormat == VertexFormat::Quantized) {
+        _positionRange = computeQuantizationRange(minimum, maximum);
     }
+}
 
-    if (hasNormals())
-    {
-        glEnableVertexAttribArray(NORMAL_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(NORMAL_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(offset));
+void StaticMesh3D::setTextureCoordinateBounds(const glm::vec2& minimum, const glm::vec2& maximum)
+{
+    if (_vertexFormat == VertexFormat::Quantized) {
+        _textureCoordinateRange = computeQuantizationRange(glm::vec3(minimum, 0.0f), glm::vec3(maximum, 0.0f));
+    }
+}
+
+bool StaticMesh3D::hasAttribute(int attributeIndex) const
+{
+    if (attributeIndex == POSITION_ATTRIBUTE_INDEX) {
+        return hasPositions();
+    }
+    if (attributeIndex == NORMAL_ATTRIBUTE_INDEX) {
+        return hasNormals();
+    }
+
+    return hasTextureCoordinates();
+}
 
-        offset += sizeof(glm::vec3)*numVertices;
+size_t StaticMesh3D::getAttributeByteSize(int attributeIndex) const
+{
+    // Quantized positions get 4 components instead of 3, so that every attribute stays 4-byte aligned
+    const auto isQuantized = _vertexFormat == VertexFormat::Quantized;
+    if (attributeIndex == POSITION_ATTRIBUTE_INDEX) {
+        return isQuantized ? sizeof(QuantizedPosition) : sizeof(glm::vec3);
+    }
+    if (attributeIndex == NORMAL_ATTRIBUTE_INDEX) {
+        return isQuantized ? sizeof(uint32_t) : sizeof(glm::vec3);
     }
+
+    return isQuantized ? sizeof(uint32_t) : sizeof(glm::vec2);
 }
 
 } // namespace static_meshes_3D
\ No newline at end of file
@@ -5,9 +5,39 @@
 
 // Project
 #include "vertexBufferObject.h"
+#include "vertexQuantization.h"
+#include "vertexFormatDescription.h"
 
 namespace static_meshes_3D {
 
+/**
+ * How vertex attributes of a mesh are laid out in its vertex buffer.
+ */
+enum class VertexLayout
+{
+	Planar, // Blocks of attributes: all positions, then all normals, then all texture coordinates
+	Interleaved // Array of structs: attributes of one vertex next to each other, one cache line per vertex fetch
+};
+
+/**
+ * How vertex attributes of a mesh are stored in its vertex buffer.
+ */
+enum class VertexFormat
+{
+	Float, // Positions, texture coordinates and normals as 32-bit floats (32 bytes per vertex)
+	Quantized // 16-bit normalized positions and texture coordinates relative to the mesh's bounds of each
+	          // and octahedral 16-bit normals (16 bytes per vertex), decoded by the vertex shader
+};
+
+/**
+ * Where an attribute lives in the vertex buffer.
+ */
+struct VertexAttributePlacement
+{
+	size_t offset; // Byte offset of the attribute of the first vertex
+	size_t stride; // Bytes between attributes of consecutive vertices
+};
+
 /**
  * Represents generic 3D static mesh.
  */
@@ -15,10 +45,11 @@ class StaticMesh3D
 {
 public:
 	static const int POSITION_ATTRIBUTE_INDEX; // Vertex attribute index of vertex position (0)
-	static const int TEXTURE_COORDINATE_ATTRIBUTE_INDEX; // Vertex attribute index of texture coordinate (1)
-	static const int NORMAL_ATTRIBUTE_INDEX; // Vertex attribute index of vertex normal (2)
+	static const int NORMAL_ATTRIBUTE_INDEX; // Vertex attribute index of vertex normal (1, as the scene shaders expect it)
+	static const int TEXTURE_COORDINATE_ATTRIBUTE_INDEX; // Vertex attribute index of texture coordinate (2)
 
-	StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals);
+	StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals,
+		VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float);
 	virtual ~StaticMesh3D();
 
 	/**
@@ -26,6 +57,13 @@ public:
 	 */
 	virtual void render() const = 0;
 
+	/**
+	 * Renders given number of instances of static mesh in one draw call, the shader tells them apart
+	 * by gl_InstanceID (or by instanced attributes set up by the caller). Default implementation does
+	 * nothing, because only some meshes support it.
+	 */
+	virtual void renderInstanced(int /*numInstances*/) const {}
+
 	/**
 	 * Renders static mesh as points only. Default implementation does nothing,
 	 * because different meshes have different logic for rendering points).
@@ -57,14 +95,62 @@ public:
 	 */
 	int getVertexByteSize() const;
 
+	/**
+	 * Gets layout of vertex attributes in the vertex buffer.
+	 */
+	VertexLayout getVertexLayout() const;
+
+	/**
+	 * Gets format of vertex attributes in the vertex buffer.
+	 */
+	VertexFormat getVertexFormat() const;
+
+	/**
+	 * Gets range quantized positions map back to (set it as uniforms positionOrigin / positionScale,
+	 * when the mesh has VertexFormat::Quantized). Identity range for float meshes.
+	 */
+	const QuantizationRange& getPositionRange() const;
+
+	/**
+	 * Gets range quantized texture coordinates map back to (uniforms texCoordOrigin / texCoordScale,
+	 * x and y only). Identity range for float meshes.
+	 */
+	const QuantizationRange& getTextureCoordinateRange() const;
+
+	/**
+	 * Sets uniforms positionOrigin, positionScale, texCoordOrigin and texCoordScale of given program
+	 * (which must be in use) to the ranges of the mesh, so that the shader decodes quantized vertices.
+	 * Float meshes set identity ranges, so one program can draw meshes of both formats.
+	 */
+	void setQuantizationUniforms(GLuint programID) const;
+
+	/**
+	 * Gets where given (present) attribute lives in a vertex buffer of given number of vertices.
+	 *
+	 * @param attributeIndex  One of the *_ATTRIBUTE_INDEX constants
+	 * @param numVertices     Number of vertices present in the buffer
+	 */
+	VertexAttributePlacement getAttributePlacement(int attributeIndex, int numVertices) const;
+
+	/**
+	 * Gets all present attributes as set by glVertexAttribPointer, for a vertex buffer of given number of vertices.
+	 * Interleaved meshes of equal attributes and format get equal descriptions whatever their vertex count.
+	 */
+	VertexFormatDescription getVertexFormatDescription(int numVertices) const;
+
 protected:
 	bool _hasPositions = false; // Flag telling, if we have vertex positions
 	bool _hasTextureCoordinates = false; // Flag telling, if we have texture coordinates
 	bool _hasNormals = false; // Flag telling, if we have vertex normals
+	VertexLayout _vertexLayout = VertexLayout::Planar; // Layout of attributes in the VBO
+	VertexFormat _vertexFormat = VertexFormat::Float; // Format of attributes in the VBO
+	QuantizationRange _positionRange; // Range of quantized positions (set by meshes before writing vertices)
+	QuantizationRange _textureCoordinateRange; // Range of quantized texture coordinates (likewise)
 
 	bool _isInitialized = false; // Is mesh initialized flag
 	GLuint _vao = 0; // VAO ID from OpenGL
 	VertexBufferObject _vbo; // Our VBO wrapper class holding static mesh data
+	VertexBufferObject _indicesVbo; // Element buffer of indexed meshes (never created for the others)
 
 	/**
 	 * Initializes vertex data. Default implementation does nothing as its not needed for all classes
@@ -72,11 +158,34 @@ protected:
 	virtual void initializeData() {}
 
 	/**
-	* Sets vertex attribute pointers in a standard way.
+	* Sets vertex attribute pointers in a standard way, for the mesh's vertex layout.
 	*
 	* @param numVertices  Number of vertices present in the buffer
 	*/
 	void setVertexAttributesPointers(int numVertices);
+
+	/**
+	 * Sets bounds of the mesh positions, quantized positions are relative to them.
+	 * Must be called before the vertices are written.
+	 */
+	void setPositionBounds(const glm::vec3& minimum, const glm::vec3& maximum);
+
+	/**
+	 * Sets bounds of the mesh texture coordinates, quantized texture coordinates are relative to them.
+	 * Must be called before the vertices are written.
+	 */
+	void setTextureCoordinateBounds(const glm::vec2& minimum, const glm::vec2& maximum);
+
+private:
+	/**
+	 * Checks, if static mesh has given attribute.
+	 */
+	bool hasAttribute(int attributeIndex) const;
+
+	/**
+	 * Gets byte size of given attribute of one vertex, for the mesh's vertex format.
+	 */
+	size_t getAttributeByteSize(int attributeIndex) const;
 };
 
 }; // namespace static_meshes_3D
\ No newline at end of file
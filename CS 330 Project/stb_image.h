@@ -454,6 +454,27 @@ extern "C" {
 	// calling it will fail to link if your compiler doesn't
 	STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_flip);
 
+	// decode JPEGs at 1/2, 1/4 or 1/8 of their size (log2_factor 1, 2 or 3; 0 decodes full size)
+	// straight from the DCT coefficients, so time and memory shrink along with the image;
+	// the reported width and height are the reduced ones. other formats are not affected
+	STBIDEF void stbi_set_jpeg_downscale_on_load(int log2_factor);
+	// as above, but only for the calling thread (overrides the global setting; decoding threads
+	// can then each use their own factor without racing on the global one)
+	STBIDEF void stbi_set_jpeg_downscale_on_load_thread(int log2_factor);
+
+	// PNG rows are unfiltered with SSE2 where available (the default); output is identical
+	// either way, turning it off is only useful to measure the difference
+	STBIDEF void stbi_set_png_simd_unfilter(int flag_true_if_should_use_simd);
+
+	// lets a single large JPEG be decoded on several threads: entropy decoding is split at the
+	// restart markers of the file (if it has any) and color conversion into bands of rows.
+	// parallel_for must call task(task_data, i) for every i in [0, count), possibly concurrently,
+	// and return once all calls are done. NULL (the default) decodes on the calling thread only.
+	// the setting is read by every decode unguarded, so set it before decoding on other threads
+	typedef void(*stbi_parallel_task)(void *task_data, int index);
+	typedef void(*stbi_parallel_for)(void *user, int count, stbi_parallel_task task, void *task_data);
+	STBIDEF void stbi_set_jpeg_parallel_for(stbi_parallel_for parallel_for, void *user);
+
 	// ZLIB client - used by PNG, available for other purposes
 
 	STBIDEF char *stbi_zlib_decode_malloc_guesssize(const char *buffer, int len, int initial_size, int *outlen);
@@ -674,7 +695,7 @@ static int stbi__cpuid3(void)
 
 #define STBI_SIMD_ALIGN(type, name) __declspec(align(16)) type name
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
 	int info3 = stbi__cpuid3();
@@ -685,7 +706,7 @@ static int stbi__sse2_available(void)
 #else // assume GCC-style if not VC++
 #define STBI_SIMD_ALIGN(type, name) type name __attribute__((aligned(16)))
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
 	// If we're even attempting to compile this on GCC/Clang, that means
@@ -1009,6 +1030,22 @@ STBIDEF void stbi_set_flip_vertically_on_load(int flag_true_if_should_flip)
 	stbi__vertically_flip_on_load_global = flag_true_if_should_flip;
 }
 
+static int stbi__jpeg_downscale_global = 0;
+
+STBIDEF void stbi_set_jpeg_downscale_on_load(int log2_factor)
+{
+	stbi__jpeg_downscale_global = log2_factor < 0 ? 0 : log2_factor > 3 ? 3 : log2_factor;
+}
+
+static stbi_parallel_for stbi__jpeg_parallel_for_global = NULL;
+static void *stbi__jpeg_parallel_for_user_global = NULL;
+
+STBIDEF void stbi_set_jpeg_parallel_for(stbi_parallel_for parallel_for, void *user)
+{
+	stbi__jpeg_parallel_for_global = parallel_for;
+	stbi__jpeg_parallel_for_user_global = user;
+}
+
 #ifndef STBI_THREAD_LOCAL
 #define stbi__vertically_flip_on_load  stbi__vertically_flip_on_load_global
 #else
@@ -1025,6 +1062,22 @@ STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_fli
                                          : stbi__vertically_flip_on_load_global)
 #endif // STBI_THREAD_LOCAL
 
+#ifndef STBI_THREAD_LOCAL
+#define stbi__jpeg_downscale  stbi__jpeg_downscale_global
+#else
+static STBI_THREAD_LOCAL int stbi__jpeg_downscale_local, stbi__jpeg_downscale_set;
+
+STBIDEF void stbi_set_jpeg_downscale_on_load_thread(int log2_factor)
+{
+	stbi__jpeg_downscale_local = log2_factor < 0 ? 0 : log2_factor > 3 ? 3 : log2_factor;
+	stbi__jpeg_downscale_set = 1;
+}
+
+#define stbi__jpeg_downscale  (stbi__jpeg_downscale_set         \
+                               ? stbi__jpeg_downscale_local    \
+                               : stbi__jpeg_downscale_global)
+#endif // STBI_THREAD_LOCAL
+
 static void *stbi__load_main(stbi__context *s, int *x, int *y, int *comp, int req_comp, stbi__result_info *ri, int bpc)
 {
 	memset(ri, 0, sizeof(*ri)); // make sure it's initialized if we add new fields
@@ -1873,6 +1926,9 @@ typedef struct
 
 	int scan_n, order[4];
 	int restart_interval, todo;
+	int scale_shift; // log2 of the downscale factor, blocks decode to (8 >> scale_shift)^2 pixels
+	stbi_parallel_for parallel_for; // NULL to decode on the calling thread only
+	void *parallel_for_user;
 
 	// kernels
 	void(*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
@@ -2400,6 +2456,58 @@ static void stbi__idct_block(stbi_uc *out, int out_stride, short data[64])
 	}
 }
 
+// reduced-size IDCT: an N-point inverse DCT of the N*N lowest frequencies of a block gives
+// the block downscaled to N*N pixels (N = 4, 2 or 1). the constants are C(u)/2 * cos(k*pi/8)
+// in 12-bit fixed point, the same scaling as the full 8-point transform
+#define STBI__IDCT4_C4  1448 // 1/(2*sqrt(2)), also C(0)/2
+#define STBI__IDCT4_C2  1892 // cos(pi/8)/2
+#define STBI__IDCT4_C6   784 // cos(3*pi/8)/2
+
+#define STBI__IDCT4_1D(s0,s1,s2,s3) \
+	int e0 = ((s0) + (s2)) * STBI__IDCT4_C4, e1 = ((s0) - (s2)) * STBI__IDCT4_C4; \
+	int o0 = (s1) * STBI__IDCT4_C2 + (s3) * STBI__IDCT4_C6; \
+	int o1 = (s1) * STBI__IDCT4_C6 - (s3) * STBI__IDCT4_C2; \
+	int t0 = e0 + o0, t1 = e1 + o1, t2 = e1 - o1, t3 = e0 - o0
+
+static void stbi__idct_block_reduced(stbi_uc *out, int out_stride, short data[64], int size)
+{
+	int i, tmp[16];
+	if (size == 1) {
+		// DC only: the block average
+		out[0] = stbi__clamp(((data[0] + 4) >> 3) + 128);
+	}
+	else if (size == 2) {
+		int a = (data[0] + data[8]) * STBI__IDCT4_C4, b = (data[0] - data[8]) * STBI__IDCT4_C4;
+		int c = (data[1] + data[9]) * STBI__IDCT4_C4, d = (data[1] - data[9]) * STBI__IDCT4_C4;
+		// columns kept with 3 extra bits, then the rows add the level shift and round
+		a = (a + (1 << 8)) >> 9; b = (b + (1 << 8)) >> 9;
+		c = (c + (1 << 8)) >> 9; d = (d + (1 << 8)) >> 9;
+		out[0] = stbi__clamp(((a + c) * STBI__IDCT4_C4 + (128 << 15) + (1 << 14)) >> 15);
+		out[1] = stbi__clamp(((a - c) * STBI__IDCT4_C4 + (128 << 15) + (1 << 14)) >> 15);
+		out += out_stride;
+		out[0] = stbi__clamp(((b + d) * STBI__IDCT4_C4 + (128 << 15) + (1 << 14)) >> 15);
+		out[1] = stbi__clamp(((b - d) * STBI__IDCT4_C4 + (128 << 15) + (1 << 14)) >> 15);
+	}
+	else {
+		// columns, keeping 3 extra bits of precision
+		for (i = 0; i < 4; ++i) {
+			STBI__IDCT4_1D(data[i], data[8 + i], data[16 + i], data[24 + i]);
+			tmp[i] = (t0 + (1 << 8)) >> 9;
+			tmp[4 + i] = (t1 + (1 << 8)) >> 9;
+			tmp[8 + i] = (t2 + (1 << 8)) >> 9;
+			tmp[12 + i] = (t3 + (1 << 8)) >> 9;
+		}
+		// rows, adding the level shift and rounding in the final descale
+		for (i = 0; i < 4; ++i, out += out_stride) {
+			STBI__IDCT4_1D(tmp[i * 4], tmp[i * 4 + 1], tmp[i * 4 + 2], tmp[i * 4 + 3]);
+			out[0] = stbi__clamp((t0 + (128 << 15) + (1 << 14)) >> 15);
+			out[1] = stbi__clamp((t1 + (128 << 15) + (1 << 14)) >> 15);
+			out[2] = stbi__clamp((t2 + (128 << 15) + (1 << 14)) >> 15);
+			out[3] = stbi__clamp((t3 + (128 << 15) + (1 << 14)) >> 15);
+		}
+	}
+}
+
 #ifdef STBI_SSE2
 // sse2 integer IDCT. not the fastest possible implementation but it
 // produces bit-identical results to the generic C version so it's
@@ -2823,6 +2931,17 @@ static void stbi__jpeg_reset(stbi__jpeg *j)
 	// since we don't even allow 1<<30 pixels
 }
 
+// inverse transform of the block at (bx,by) into component n; with downscaling, blocks are (8 >> scale_shift) pixels wide
+static void stbi__jpeg_idct_put(stbi__jpeg *z, int n, int bx, int by, short data[64])
+{
+	int size = 8 >> z->scale_shift;
+	stbi_uc *out = z->img_comp[n].data + z->img_comp[n].w2*by*size + bx*size;
+	if (size == 8)
+		z->idct_block_kernel(out, z->img_comp[n].w2, data);
+	else
+		stbi__idct_block_reduced(out, z->img_comp[n].w2, data, size);
+}
+
 static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 {
 	stbi__jpeg_reset(z);
@@ -2841,7 +2960,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 				for (i = 0; i < w; ++i) {
 					int ha = z->img_comp[n].ha;
 					if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-					z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2*j * 8 + i * 8, z->img_comp[n].w2, data);
+					stbi__jpeg_idct_put(z, n, i, j, data);
 					// every data block is an MCU, so countdown the restart interval
 					if (--z->todo <= 0) {
 						if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
@@ -2866,11 +2985,11 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 						// by the basic H and V specified for the component
 						for (y = 0; y < z->img_comp[n].v; ++y) {
 							for (x = 0; x < z->img_comp[n].h; ++x) {
-								int x2 = (i*z->img_comp[n].h + x) * 8;
-								int y2 = (j*z->img_comp[n].v + y) * 8;
+								int x2 = (i*z->img_comp[n].h + x);
+								int y2 = (j*z->img_comp[n].v + y);
 								int ha = z->img_comp[n].ha;
 								if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-								z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2*y2 + x2, z->img_comp[n].w2, data);
+								stbi__jpeg_idct_put(z, n, x2, y2, data);
 							}
 						}
 					}
@@ -2951,6 +3070,140 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 	}
 }
 
+// smallest scans and images worth splitting across threads
+#define STBI__JPEG_PARALLEL_MIN_MCUS    1024
+#define STBI__JPEG_PARALLEL_MIN_PIXELS  (1 << 20)
+#define STBI__JPEG_PARALLEL_MAX_TASKS   64
+
+// decodes count MCUs of a baseline scan starting at MCU first, without looking for restarts
+static int stbi__jpeg_decode_mcus(stbi__jpeg *z, int first, int count)
+{
+	int m, k, x, y;
+	STBI_SIMD_ALIGN(short, data[64]);
+	for (m = first; m < first + count; ++m) {
+		if (z->scan_n == 1) {
+			// non-interleaved: every block is an MCU
+			int n = z->order[0];
+			int w = (z->img_comp[n].x + 7) >> 3;
+			int ha = z->img_comp[n].ha;
+			if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+			stbi__jpeg_idct_put(z, n, m % w, m / w, data);
+		}
+		else {
+			int i = m % z->img_mcu_x, j = m / z->img_mcu_x;
+			for (k = 0; k < z->scan_n; ++k) {
+				int n = z->order[k];
+				for (y = 0; y < z->img_comp[n].v; ++y) {
+					for (x = 0; x < z->img_comp[n].h; ++x) {
+						int ha = z->img_comp[n].ha;
+						if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+						stbi__jpeg_idct_put(z, n, i*z->img_comp[n].h + x, j*z->img_comp[n].v + y, data);
+					}
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+typedef struct
+{
+	stbi__jpeg *z;
+	stbi_uc **segments; // start of every restart interval, followed by the end of the scan
+	int num_segments;
+	int num_mcus;
+	int num_tasks;
+	int *results;
+} stbi__jpeg_parallel_scan;
+
+// decodes a run of restart intervals; they are independent, so each task works on its own
+// copy of the decoder state and reads its intervals through its own memory context
+static void stbi__jpeg_decode_intervals(void *task_data, int index)
+{
+	stbi__jpeg_parallel_scan *scan = (stbi__jpeg_parallel_scan *)task_data;
+	int first = index * scan->num_segments / scan->num_tasks;
+	int end = (index + 1) * scan->num_segments / scan->num_tasks;
+	int interval = scan->z->restart_interval;
+	int seg;
+	stbi__context s = *scan->z->s;
+	stbi__jpeg *local = (stbi__jpeg *)stbi__malloc(sizeof(stbi__jpeg));
+	scan->results[index] = 0;
+	if (!local) return;
+	*local = *scan->z;
+	local->s = &s;
+	for (seg = first; seg < end; ++seg) {
+		int mcu = seg * interval;
+		int count = scan->num_mcus - mcu < interval ? scan->num_mcus - mcu : interval;
+		stbi__start_mem(&s, scan->segments[seg], (int)(scan->segments[seg + 1] - scan->segments[seg]));
+		stbi__jpeg_reset(local);
+		if (!stbi__jpeg_decode_mcus(local, mcu, count)) { STBI_FREE(local); return; }
+	}
+	scan->results[index] = 1;
+	STBI_FREE(local);
+}
+
+// decodes a baseline scan with restart intervals on several threads, all of it must be in memory.
+// returns -1 if the scan can't be split (and nothing has been read), otherwise 0 on error, 1 when done
+static int stbi__parse_entropy_coded_data_parallel(stbi__jpeg *z)
+{
+	stbi__context *s = z->s;
+	stbi__jpeg_parallel_scan scan;
+	stbi_uc *p, *end = NULL;
+	int i, expected, result = 1;
+
+	if (!z->parallel_for || z->progressive || !z->restart_interval || s->read_from_callbacks) return -1;
+	if (z->scan_n == 1)
+		scan.num_mcus = ((z->img_comp[z->order[0]].x + 7) >> 3) * ((z->img_comp[z->order[0]].y + 7) >> 3);
+	else
+		scan.num_mcus = z->img_mcu_x * z->img_mcu_y;
+	if (scan.num_mcus < STBI__JPEG_PARALLEL_MIN_MCUS) return -1;
+	expected = (scan.num_mcus + z->restart_interval - 1) / z->restart_interval;
+	if (expected < 2) return -1;
+
+	scan.segments = (stbi_uc **)stbi__malloc_mad2(expected + 1, sizeof(stbi_uc *), 0);
+	if (!scan.segments) return -1;
+
+	// find the restart markers; the first other marker ends the scan. each interval keeps its
+	// marker, so every task sees the same bytes the serial decoder would
+	scan.num_segments = 0;
+	scan.segments[scan.num_segments++] = s->img_buffer;
+	for (p = s->img_buffer; p < s->img_buffer_end; ) {
+		stbi_uc *q = p + 1;
+		if (*p != 0xff) { ++p; continue; }
+		while (q < s->img_buffer_end && *q == 0xff) ++q; // fill bytes
+		if (q == s->img_buffer_end) break;
+		if (*q == 0x00) { p = q + 1; continue; } // stuffed 0xff data byte
+		if (!STBI__RESTART(*q)) { end = p; break; }
+		if (scan.num_segments == expected) break;
+		scan.segments[scan.num_segments++] = q + 1;
+		p = q + 1;
+	}
+	if (!end || scan.num_segments != expected) {
+		// truncated or unusual data, leave it to the serial decoder
+		STBI_FREE(scan.segments);
+		return -1;
+	}
+	scan.segments[expected] = end;
+
+	scan.z = z;
+	scan.num_tasks = expected < STBI__JPEG_PARALLEL_MAX_TASKS ? expected : STBI__JPEG_PARALLEL_MAX_TASKS;
+	scan.results = (int *)stbi__malloc_mad2(scan.num_tasks, sizeof(int), 0);
+	if (!scan.results) {
+		STBI_FREE(scan.segments);
+		return -1;
+	}
+	z->parallel_for(z->parallel_for_user, scan.num_tasks, stbi__jpeg_decode_intervals, &scan);
+	for (i = 0; i < scan.num_tasks; ++i)
+		if (!scan.results[i]) result = stbi__err("bad interval", "Corrupt JPEG");
+	STBI_FREE(scan.results);
+	STBI_FREE(scan.segments);
+
+	// continue after the scan, as the serial decoder does once it has hit the marker
+	s->img_buffer = end;
+	z->marker = STBI__MARKER_none;
+	return result;
+}
+
 static void stbi__jpeg_dequantize(short *data, stbi__uint16 *dequant)
 {
 	int i;
@@ -2970,7 +3223,7 @@ static void stbi__jpeg_finish(stbi__jpeg *z)
 				for (i = 0; i < w; ++i) {
 					short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
 					stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-					z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2*j * 8 + i * 8, z->img_comp[n].w2, data);
+					stbi__jpeg_idct_put(z, n, i, j, data);
 				}
 			}
 		}
@@ -3203,8 +3456,9 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
 		//
 		// img_mcu_x, img_mcu_y: <=17 bits; comp[i].h and .v are <=4 (checked earlier)
 		// so these muls can't overflow with 32-bit ints (which we require)
-		z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * 8;
-		z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * 8;
+		// (downscaled decoding stores every block at its reduced size)
+		z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * (8 >> z->scale_shift);
+		z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * (8 >> z->scale_shift);
 		z->img_comp[i].coeff = 0;
 		z->img_comp[i].raw_coeff = 0;
 		z->img_comp[i].linebuf = NULL;
@@ -3214,10 +3468,10 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
 		// align blocks for idct using mmx/sse
 		z->img_comp[i].data = (stbi_uc*)(((size_t)z->img_comp[i].raw_data + 15) & ~15);
 		if (z->progressive) {
-			// w2, h2 are multiples of 8 (see above)
-			z->img_comp[i].coeff_w = z->img_comp[i].w2 / 8;
-			z->img_comp[i].coeff_h = z->img_comp[i].h2 / 8;
-			z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].w2, z->img_comp[i].h2, sizeof(short), 15);
+			// coefficients are kept at full size, one 8x8 block per stored block
+			z->img_comp[i].coeff_w = z->img_mcu_x * z->img_comp[i].h;
+			z->img_comp[i].coeff_h = z->img_mcu_y * z->img_comp[i].v;
+			z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].coeff_w * 8, z->img_comp[i].coeff_h * 8, sizeof(short), 15);
 			if (z->img_comp[i].raw_coeff == NULL)
 				return stbi__free_jpeg_components(z, i + 1, stbi__err("outofmem", "Out of memory"));
 			z->img_comp[i].coeff = (short*)(((size_t)z->img_comp[i].raw_coeff + 15) & ~15);
@@ -3273,8 +3527,11 @@ static int stbi__decode_jpeg_image(stbi__jpeg *j)
 	m = stbi__get_marker(j);
 	while (!stbi__EOI(m)) {
 		if (stbi__SOS(m)) {
+			int parsed;
 			if (!stbi__process_scan_header(j)) return 0;
-			if (!stbi__parse_entropy_coded_data(j)) return 0;
+			parsed = stbi__parse_entropy_coded_data_parallel(j);
+			if (parsed < 0) parsed = stbi__parse_entropy_coded_data(j);
+			if (!parsed) return 0;
 			if (j->marker == STBI__MARKER_none) {
 				// handle 0s at the end of image data from IP Kamera 9060
 				while (!stbi__at_eof(j->s)) {
@@ -3677,6 +3934,9 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg *j)
 {
+	j->scale_shift = stbi__jpeg_downscale;
+	j->parallel_for = stbi__jpeg_parallel_for_global;
+	j->parallel_for_user = stbi__jpeg_parallel_for_user_global;
 	j->idct_block_kernel = stbi__idct_block;
 	j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
 	j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
@@ -3719,6 +3979,165 @@ static stbi_uc stbi__blinn_8x8(stbi_uc x, stbi_uc y)
 	return (stbi_uc)((t + (t >> 8)) >> 8);
 }
 
+static void stbi__jpeg_resample_next_row(stbi__jpeg *z, stbi__resample *r, int k)
+{
+	if (++r->ystep >= r->vs) {
+		r->ystep = 0;
+		r->line0 = r->line1;
+		if (++r->ypos < z->img_comp[k].y)
+			r->line1 += z->img_comp[k].w2;
+	}
+}
+
+// resamples and color-converts num_rows rows into output (the first of them), at the row res_comp is at.
+// 3-component rows are written with 4-byte pixels, so each row spills one byte into the next
+static void stbi__jpeg_convert_rows(stbi__jpeg *z, stbi__resample *res_comp, stbi_uc **linebufs, stbi_uc *output, int n, int decode_n, int is_rgb, unsigned int num_rows)
+{
+	int k;
+	unsigned int i, j;
+	stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
+	for (j = 0; j < num_rows; ++j) {
+		stbi_uc *out = output + n * z->s->img_x * j;
+		for (k = 0; k < decode_n; ++k) {
+			stbi__resample *r = &res_comp[k];
+			int y_bot = r->ystep >= (r->vs >> 1);
+			coutput[k] = r->resample(linebufs[k],
+				y_bot ? r->line1 : r->line0,
+				y_bot ? r->line0 : r->line1,
+				r->w_lores, r->hs);
+			stbi__jpeg_resample_next_row(z, r, k);
+		}
+		if (n >= 3) {
+			stbi_uc *y = coutput[0];
+			if (z->s->img_n == 3) {
+				if (is_rgb) {
+					for (i = 0; i < z->s->img_x; ++i) {
+						out[0] = y[i];
+						out[1] = coutput[1][i];
+						out[2] = coutput[2][i];
+						out[3] = 255;
+						out += n;
+					}
+				}
+				else {
+					z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+				}
+			}
+			else if (z->s->img_n == 4) {
+				if (z->app14_color_transform == 0) { // CMYK
+					for (i = 0; i < z->s->img_x; ++i) {
+						stbi_uc m = coutput[3][i];
+						out[0] = stbi__blinn_8x8(coutput[0][i], m);
+						out[1] = stbi__blinn_8x8(coutput[1][i], m);
+						out[2] = stbi__blinn_8x8(coutput[2][i], m);
+						out[3] = 255;
+						out += n;
+					}
+				}
+				else if (z->app14_color_transform == 2) { // YCCK
+					z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+					for (i = 0; i < z->s->img_x; ++i) {
+						stbi_uc m = coutput[3][i];
+						out[0] = stbi__blinn_8x8(255 - out[0], m);
+						out[1] = stbi__blinn_8x8(255 - out[1], m);
+						out[2] = stbi__blinn_8x8(255 - out[2], m);
+						out += n;
+					}
+				}
+				else { // YCbCr + alpha?  Ignore the fourth channel for now
+					z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+				}
+			}
+			else
+				for (i = 0; i < z->s->img_x; ++i) {
+					out[0] = out[1] = out[2] = y[i];
+					out[3] = 255; // not used if n==3
+					out += n;
+				}
+		}
+		else {
+			if (is_rgb) {
+				if (n == 1)
+					for (i = 0; i < z->s->img_x; ++i)
+						*out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+				else {
+					for (i = 0; i < z->s->img_x; ++i, out += 2) {
+						out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+						out[1] = 255;
+					}
+				}
+			}
+			else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
+				for (i = 0; i < z->s->img_x; ++i) {
+					stbi_uc m = coutput[3][i];
+					stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
+					stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
+					stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
+					out[0] = stbi__compute_y(r, g, b);
+					out[1] = 255;
+					out += n;
+				}
+			}
+			else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
+				for (i = 0; i < z->s->img_x; ++i) {
+					out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
+					out[1] = 255;
+					out += n;
+				}
+			}
+			else {
+				stbi_uc *y = coutput[0];
+				if (n == 1)
+					for (i = 0; i < z->s->img_x; ++i) out[i] = y[i];
+				else
+					for (i = 0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
+			}
+		}
+	}
+}
+
+typedef struct
+{
+	stbi__jpeg *z;
+	stbi__resample *res_comp; // resamplers at the first row
+	stbi_uc *output;
+	int n, decode_n, is_rgb;
+	int num_bands;
+	int *results;
+} stbi__jpeg_parallel_convert;
+
+// converts one band of rows with its own resampler state and line buffers
+static void stbi__jpeg_convert_band(void *task_data, int index)
+{
+	stbi__jpeg_parallel_convert *convert = (stbi__jpeg_parallel_convert *)task_data;
+	stbi__jpeg *z = convert->z;
+	unsigned int j_begin = (unsigned int)index * z->s->img_y / convert->num_bands;
+	unsigned int j_end = (unsigned int)(index + 1) * z->s->img_y / convert->num_bands;
+	size_t row_size = (size_t)convert->n * z->s->img_x;
+	unsigned int j;
+	stbi__resample res_comp[4];
+	stbi_uc *linebufs[4] = { NULL, NULL, NULL, NULL };
+	stbi_uc *last_row = (stbi_uc *)stbi__malloc(row_size + 1);
+	int k;
+	convert->results[index] = last_row != NULL;
+	for (k = 0; k < convert->decode_n; ++k) {
+		res_comp[k] = convert->res_comp[k];
+		for (j = 0; j < j_begin; ++j)
+			stbi__jpeg_resample_next_row(z, &res_comp[k], k);
+		linebufs[k] = (stbi_uc *)stbi__malloc(z->s->img_x + 3);
+		if (!linebufs[k]) convert->results[index] = 0;
+	}
+	if (convert->results[index]) {
+		// the last row goes through a buffer, so that it can't spill into the next band
+		stbi__jpeg_convert_rows(z, res_comp, linebufs, convert->output + row_size * j_begin, convert->n, convert->decode_n, convert->is_rgb, j_end - j_begin - 1);
+		stbi__jpeg_convert_rows(z, res_comp, linebufs, last_row, convert->n, convert->decode_n, convert->is_rgb, 1);
+		memcpy(convert->output + row_size * (j_end - 1), last_row, row_size);
+	}
+	for (k = 0; k < convert->decode_n; ++k)
+		STBI_FREE(linebufs[k]);
+	STBI_FREE(last_row);
+}
+
 static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp, int req_comp)
 {
 	int n, decode_n, is_rgb;
@@ -3730,6 +4149,17 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
 	// load a jpeg image from whichever source, but leave in YCbCr format
 	if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
 
+	// downscaled planes hold reduced-size pixels, so everything from here on works at that size
+	if (z->scale_shift) {
+		int round = (1 << z->scale_shift) - 1;
+		z->s->img_x = (z->s->img_x + round) >> z->scale_shift;
+		z->s->img_y = (z->s->img_y + round) >> z->scale_shift;
+		for (n = 0; n < z->s->img_n; ++n) {
+			z->img_comp[n].x = (z->img_comp[n].x + round) >> z->scale_shift;
+			z->img_comp[n].y = (z->img_comp[n].y + round) >> z->scale_shift;
+		}
+	}
+
 	// determine actual number of components to generate
 	n = req_comp ? req_comp : z->s->img_n >= 3 ? 3 : 1;
 
@@ -3743,9 +4173,7 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
 	// resample and color-convert
 	{
 		int k;
-		unsigned int i, j;
 		stbi_uc *output;
-		stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
 
 		stbi__resample res_comp[4];
 
@@ -3775,110 +4203,37 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
 		output = (stbi_uc *)stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
 		if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
 
-		// now go ahead and resample
-		for (j = 0; j < z->s->img_y; ++j) {
-			stbi_uc *out = output + n * z->s->img_x * j;
-			for (k = 0; k < decode_n; ++k) {
-				stbi__resample *r = &res_comp[k];
-				int y_bot = r->ystep >= (r->vs >> 1);
-				coutput[k] = r->resample(z->img_comp[k].linebuf,
-					y_bot ? r->line1 : r->line0,
-					y_bot ? r->line0 : r->line1,
-					r->w_lores, r->hs);
-				if (++r->ystep >= r->vs) {
-					r->ystep = 0;
-					r->line0 = r->line1;
-					if (++r->ypos < z->img_comp[k].y)
-						r->line1 += z->img_comp[k].w2;
-				}
-			}
-			if (n >= 3) {
-				stbi_uc *y = coutput[0];
-				if (z->s->img_n == 3) {
-					if (is_rgb) {
-						for (i = 0; i < z->s->img_x; ++i) {
-							out[0] = y[i];
-							out[1] = coutput[1][i];
-							out[2] = coutput[2][i];
-							out[3] = 255;
-							out += n;
-						}
-					}
-					else {
-						z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-					}
-				}
-				else if (z->s->img_n == 4) {
-					if (z->app14_color_transform == 0) { // CMYK
-						for (i = 0; i < z->s->img_x; ++i) {
-							stbi_uc m = coutput[3][i];
-							out[0] = stbi__blinn_8x8(coutput[0][i], m);
-							out[1] = stbi__blinn_8x8(coutput[1][i], m);
-							out[2] = stbi__blinn_8x8(coutput[2][i], m);
-							out[3] = 255;
-							out += n;
-						}
-					}
-					else if (z->app14_color_transform == 2) { // YCCK
-						z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-						for (i = 0; i < z->s->img_x; ++i) {
-							stbi_uc m = coutput[3][i];
-							out[0] = stbi__blinn_8x8(255 - out[0], m);
-							out[1] = stbi__blinn_8x8(255 - out[1], m);
-							out[2] = stbi__blinn_8x8(255 - out[2], m);
-							out += n;
-						}
-					}
-					else { // YCbCr + alpha?  Ignore the fourth channel for now
-						z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-					}
-				}
-				else
-					for (i = 0; i < z->s->img_x; ++i) {
-						out[0] = out[1] = out[2] = y[i];
-						out[3] = 255; // not used if n==3
-						out += n;
-					}
-			}
-			else {
-				if (is_rgb) {
-					if (n == 1)
-						for (i = 0; i < z->s->img_x; ++i)
-							*out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-					else {
-						for (i = 0; i < z->s->img_x; ++i, out += 2) {
-							out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-							out[1] = 255;
-						}
-					}
-				}
-				else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
-					for (i = 0; i < z->s->img_x; ++i) {
-						stbi_uc m = coutput[3][i];
-						stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
-						stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
-						stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
-						out[0] = stbi__compute_y(r, g, b);
-						out[1] = 255;
-						out += n;
-					}
-				}
-				else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
-					for (i = 0; i < z->s->img_x; ++i) {
-						out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
-						out[1] = 255;
-						out += n;
-					}
-				}
-				else {
-					stbi_uc *y = coutput[0];
-					if (n == 1)
-						for (i = 0; i < z->s->img_x; ++i) out[i] = y[i];
-					else
-						for (i = 0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
+		// now go ahead and resample, in bands of rows on several threads if the image is large (and tall enough for two bands)
+		if (z->parallel_for && z->s->img_x * z->s->img_y >= STBI__JPEG_PARALLEL_MIN_PIXELS && z->s->img_y >= 128) {
+			stbi__jpeg_parallel_convert convert;
+			int band, num_bands = (int)(z->s->img_y / 64);
+			convert.z = z;
+			convert.res_comp = res_comp;
+			convert.output = output;
+			convert.n = n;
+			convert.decode_n = decode_n;
+			convert.is_rgb = is_rgb;
+			convert.num_bands = num_bands < STBI__JPEG_PARALLEL_MAX_TASKS ? num_bands : STBI__JPEG_PARALLEL_MAX_TASKS;
+			convert.results = (int *)stbi__malloc_mad2(convert.num_bands, sizeof(int), 0);
+			if (!convert.results) { STBI_FREE(output); stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+			z->parallel_for(z->parallel_for_user, convert.num_bands, stbi__jpeg_convert_band, &convert);
+			for (band = 0; band < convert.num_bands; ++band) {
+				if (!convert.results[band]) {
+					STBI_FREE(convert.results);
+					STBI_FREE(output);
+					stbi__cleanup_jpeg(z);
+					return stbi__errpuc("outofmem", "Out of memory");
 				}
 			}
+			STBI_FREE(convert.results);
 		}
+		else {
+			stbi_uc *linebufs[4];
+			for (k = 0; k < decode_n; ++k)
+				linebufs[k] = z->img_comp[k].linebuf;
+			stbi__jpeg_convert_rows(z, res_comp, linebufs, output, n, decode_n, is_rgb, z->s->img_y);
+		}
+
 		stbi__cleanup_jpeg(z);
 		*out_x = z->s->img_x;
 		*out_y = z->s->img_y;
@@ -3917,8 +4272,9 @@ static int stbi__jpeg_info_raw(stbi__jpeg *j, int *x, int *y, int *comp)
 		stbi__rewind(j->s);
 		return 0;
 	}
-	if (x) *x = j->s->img_x;
-	if (y) *y = j->s->img_y;
+	// report the size a load would return
+	if (x) *x = (j->s->img_x + (1 << j->scale_shift) - 1) >> j->scale_shift;
+	if (y) *y = (j->s->img_y + (1 << j->scale_shift) - 1) >> j->scale_shift;
 	if (comp) *comp = j->s->img_n >= 3 ? 3 : 1;
 	return 1;
 }
@@ -3928,6 +4284,7 @@ static int stbi__jpeg_info(stbi__context *s, int *x, int *y, int *comp)
 	int result;
 	stbi__jpeg* j = (stbi__jpeg*)(stbi__malloc(sizeof(stbi__jpeg)));
 	j->s = s;
+	j->scale_shift = stbi__jpeg_downscale;
 	result = stbi__jpeg_info_raw(j, x, y, comp);
 	STBI_FREE(j);
 	return result;
@@ -4492,6 +4849,115 @@ static int stbi__paeth(int a, int b, int c)
 
 static const stbi_uc stbi__depth_scale_table[9] = { 0, 0xff, 0x55, 0, 0x11, 0,0,0, 0x01 };
 
+static int stbi__png_simd_unfilter_global = 1;
+
+STBIDEF void stbi_set_png_simd_unfilter(int flag_true_if_should_use_simd)
+{
+	stbi__png_simd_unfilter_global = flag_true_if_should_use_simd;
+}
+
+#ifdef STBI_SSE2
+// SSE2 versions of the row filters, bit-exact with the scalar loops. "up" works on 16 bytes
+// at a time; sub, avg and paeth depend on the pixel to the left, so they work on the bytes of
+// one pixel at a time (3 or 4 bytes, i.e. 8-bit RGB and RGBA), paeth without any branches.
+// pixels are moved bytewise, so nothing is read or written outside the row
+static stbi_inline __m128i stbi__png_load_pixel(const stbi_uc *p, int bpp)
+{
+	int v;
+	if (bpp == 4)
+		memcpy(&v, p, 4);
+	else
+		v = p[0] | (p[1] << 8) | (p[2] << 16);
+	return _mm_cvtsi32_si128(v);
+}
+
+static stbi_inline void stbi__png_store_pixel(stbi_uc *p, __m128i v, int bpp)
+{
+	int x = _mm_cvtsi128_si32(v);
+	if (bpp == 4) {
+		memcpy(p, &x, 4);
+	}
+	else {
+		p[0] = (stbi_uc)x;
+		p[1] = (stbi_uc)(x >> 8);
+		p[2] = (stbi_uc)(x >> 16);
+	}
+}
+
+static stbi_inline void stbi__png_unfilter_row_pixels_sse2(int filter, stbi_uc *cur, stbi_uc *raw, stbi_uc *prior, int nk, int bpp)
+{
+	int k;
+	__m128i zero = _mm_setzero_si128();
+	__m128i a = stbi__png_load_pixel(cur - bpp, bpp); // left
+	if (filter == STBI__F_sub) {
+		for (k = 0; k < nk; k += bpp) {
+			a = _mm_add_epi8(a, stbi__png_load_pixel(raw + k, bpp));
+			stbi__png_store_pixel(cur + k, a, bpp);
+		}
+	}
+	else if (filter == STBI__F_avg) {
+		// floor((a + b) / 2) is the rounding-up average minus the bit lost by rounding
+		__m128i one = _mm_set1_epi8(1);
+		for (k = 0; k < nk; k += bpp) {
+			__m128i b = stbi__png_load_pixel(prior + k, bpp);
+			__m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+			a = _mm_add_epi8(avg, stbi__png_load_pixel(raw + k, bpp));
+			stbi__png_store_pixel(cur + k, a, bpp);
+		}
+	}
+	else { // paeth, in 16-bit lanes
+		__m128i c = _mm_unpacklo_epi8(stbi__png_load_pixel(prior - bpp, bpp), zero); // upper left
+		__m128i mask = _mm_set1_epi16(0xff);
+		a = _mm_unpacklo_epi8(a, zero);
+		for (k = 0; k < nk; k += bpp) {
+			__m128i b = _mm_unpacklo_epi8(stbi__png_load_pixel(prior + k, bpp), zero);
+			__m128i pa = _mm_sub_epi16(b, c); // p - a
+			__m128i pb = _mm_sub_epi16(a, c); // p - b
+			__m128i pc = _mm_add_epi16(pa, pb); // p - c
+			__m128i smallest, pick_a, pick_b, nearest;
+			pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+			pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+			pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+			smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+			// ties go to a, then b, then c, as in stbi__paeth
+			pick_a = _mm_cmpeq_epi16(smallest, pa);
+			pick_b = _mm_andnot_si128(pick_a, _mm_cmpeq_epi16(smallest, pb));
+			nearest = _mm_or_si128(_mm_and_si128(pick_a, a), _mm_and_si128(pick_b, b));
+			nearest = _mm_or_si128(nearest, _mm_andnot_si128(_mm_or_si128(pick_a, pick_b), c));
+			a = _mm_and_si128(_mm_add_epi16(nearest, _mm_unpacklo_epi8(stbi__png_load_pixel(raw + k, bpp), zero)), mask);
+			stbi__png_store_pixel(cur + k, _mm_packus_epi16(a, a), bpp);
+			c = b;
+		}
+	}
+}
+
+// returns 0 for the rows left to the scalar loops
+static int stbi__png_unfilter_row_sse2(int filter, stbi_uc *cur, stbi_uc *raw, stbi_uc *prior, int nk, int filter_bytes)
+{
+	if (filter == STBI__F_up) {
+		int k = 0;
+		for (; k + 16 <= nk; k += 16) {
+			__m128i r = _mm_loadu_si128((const __m128i *) (raw + k));
+			__m128i p = _mm_loadu_si128((const __m128i *) (prior + k));
+			_mm_storeu_si128((__m128i *) (cur + k), _mm_add_epi8(r, p));
+		}
+		for (; k < nk; ++k)
+			cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+		return 1;
+	}
+	if (filter != STBI__F_sub && filter != STBI__F_avg && filter != STBI__F_paeth)
+		return 0;
+	// separate calls so the pixel size is a constant in each
+	if (filter_bytes == 3)
+		stbi__png_unfilter_row_pixels_sse2(filter, cur, raw, prior, nk, 3);
+	else if (filter_bytes == 4)
+		stbi__png_unfilter_row_pixels_sse2(filter, cur, raw, prior, nk, 4);
+	else
+		return 0;
+	return 1;
+}
+#endif
+
 // create the png data from post-deflated data
 static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
 {
@@ -4505,6 +4971,9 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
 	int output_bytes = out_n * bytes;
 	int filter_bytes = img_n * bytes;
 	int width = x;
+#ifdef STBI_SSE2
+	int use_simd = stbi__png_simd_unfilter_global && stbi__sse2_available();
+#endif
 
 	STBI_ASSERT(out_n == s->img_n || out_n == s->img_n + 1);
 	a->out = (stbi_uc *)stbi__malloc_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
@@ -4579,6 +5048,9 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
 #define STBI__CASE(f) \
              case f:     \
                 for (k=0; k < nk; ++k)
+#ifdef STBI_SSE2
+			if (!use_simd || !stbi__png_unfilter_row_sse2(filter, cur, raw, prior, nk, filter_bytes))
+#endif
 			switch (filter) {
 				// "none" filter turns into a memcpy here; make that explicit.
 			case STBI__F_none:         memcpy(cur, raw, nk); break;
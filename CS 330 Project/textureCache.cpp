@@ -0,0 +1,525 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+// Project
+#include "textureCache.h"
+#include "textureLoader.h"
+#include "textureFormat.h"
+#include "mappedFile.h"
+
+namespace {
+
+const size_t STAGING_RING_SIZE = 8 * 1024 * 1024; // Staging memory for mip level uploads
+const unsigned char PLACEHOLDER_TEXEL[4] = { 128, 128, 128, 255 }; // Neutral grey
+
+/**
+ * Decodes diffuse and specular map of a material and packs them into one RGBA image, see packMaterialImage.
+ */
+bool decodePackedMaterial(const std::string& diffusePath, const std::string& specularPath, TextureQuality quality,
+    std::vector<unsigned char>& pixels, int& width, int& height)
+{
+    DecodedImage diffuseImage, specularImage;
+    diffuseImage.quality = quality;
+    specularImage.quality = quality;
+    if (!decodeImage(diffusePath, diffuseImage)) {
+        return false;
+    }
+    if (!decodeImage(specularPath, specularImage))
+    {
+        freeDecodedImage(diffuseImage);
+        return false;
+    }
+
+    pixels = packMaterialImage(diffuseImage.pixels, diffuseImage.width, diffuseImage.height, diffuseImage.numComponents,
+        specularImage.pixels, specularImage.width, specularImage.height, specularImage.numComponents);
+    width = diffuseImage.width;
+    height = diffuseImage.height;
+    freeDecodedImage(diffuseImage);
+    freeDecodedImage(specularImage);
+    return true;
+}
+
+} // namespace
+
+TextureCache::TextureCache(ThreadPool& threadPool, size_t vramBudget)
+    : _threadPool(threadPool)
+    , _vramBudget(vramBudget)
+{
+    createPlaceholderTexture();
+}
+
+TextureCache::~TextureCache()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _entryDecoded.wait(lock, [this] { return _numDecoding == 0; });
+
+    for (const auto& entry : _entries)
+    {
+        if (entry->textureID != 0) {
+            glDeleteTextures(1, &entry->textureID);
+        }
+    }
+    glDeleteTextures(1, &_placeholderTexture);
+}
+
+TextureHandle TextureCache::getHandle(const std::string& path)
+{
+    return registerEntry(path, path, std::string());
+}
+
+TextureHandle TextureCache::getPackedHandle(const std::string& diffusePath, const std::string& specularPath)
+{
+    // '|' can't be part of a path, so the key never matches a plain texture
+    return registerEntry(diffusePath + "|" + specularPath, diffusePath, specularPath);
+}
+
+TextureHandle TextureCache::registerEntry(const std::string& key, const std::string& path, const std::string& specularPath)
+{
+    TextureHandle result;
+    _numRequests++;
+    const auto it = _indicesByPath.find(key);
+    if (it != _indicesByPath.end())
+    {
+        auto& entry = *_entries[it->second];
+        {
+            std::lock_guard<std::mutex> lock(_sharingMutex);
+            entry.numReferences++;
+        }
+        entry.numHits++;
+        _numPathHits++;
+        result.index = it->second;
+        return result;
+    }
+
+    // The entry holds the reference of its first registration
+    std::unique_ptr<Entry> entry(new Entry);
+    entry->path = path;
+    entry->specularPath = specularPath;
+    result.index = static_cast<int>(_entries.size());
+    _entries.push_back(std::move(entry));
+    _indicesByPath[key] = result.index;
+    return result;
+}
+
+void TextureCache::release(TextureHandle handle)
+{
+    if (handle.index >= 0 && handle.index < static_cast<int>(_entries.size())) {
+        releaseReference(*_entries[handle.index]);
+    }
+}
+
+GLuint TextureCache::use(TextureHandle handle)
+{
+    if (handle.index < 0 || handle.index >= static_cast<int>(_entries.size())) {
+        return _placeholderTexture;
+    }
+
+    // Duplicates are drawn with (and keep alive) the texture of the entry with the same contents
+    auto& entry = _entries[handle.index]->state == State::Shared ? *_entries[handle.index]->original : *_entries[handle.index];
+    entry.lastUsedFrame = _frame;
+    if (entry.state == State::Unloaded) {
+        startDecoding(entry);
+    }
+
+    return entry.numUploadedLevels > 0 ? entry.textureID : _placeholderTexture;
+}
+
+void TextureCache::update(size_t uploadBudget)
+{
+    _frame++;
+
+    std::vector<Entry*> decodedEntries;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        decodedEntries.swap(_decodedEntries);
+    }
+    for (auto entry : decodedEntries)
+    {
+        if (entry->original != nullptr)
+        {
+            entry->state = State::Shared;
+            entry->original->numHits++;
+            _numContentHits++;
+        }
+        else if (entry->mipLevels.empty())
+        {
+            std::cout << "Texture failed to load at path: " << entry->path << (entry->specularPath.empty() ? "" : " (packed with " + entry->specularPath + ")") << std::endl;
+            entry->state = State::Failed;
+        }
+        else
+        {
+            entry->state = State::Uploading;
+            _uploadingEntries.push_back(entry);
+        }
+
+        // Entries released while decoding are unloaded right away
+        if (entry->numReferences == 0) {
+            unloadEntry(*entry);
+        }
+    }
+
+    uploadLevels(uploadBudget);
+    evictUnusedTextures();
+
+    if (!_isSavingsReported && !_entries.empty())
+    {
+        const auto isLoaded = [](const std::unique_ptr<Entry>& entry) {
+            return entry->state == State::Resident || entry->state == State::Failed || entry->state == State::Shared || entry->numReferences == 0;
+        };
+        if (std::all_of(_entries.begin(), _entries.end(), isLoaded))
+        {
+            reportSavings();
+            _isSavingsReported = true;
+        }
+    }
+}
+
+size_t TextureCache::getResidentBytes() const
+{
+    return _residentBytes;
+}
+
+int TextureCache::getNumResident() const
+{
+    auto result = 0;
+    for (const auto& entry : _entries)
+    {
+        if (entry->numUploadedLevels > 0) {
+            result++;
+        }
+    }
+
+    return result;
+}
+
+void TextureCache::createPlaceholderTexture()
+{
+    glGenTextures(1, &_placeholderTexture);
+    glBindTexture(GL_TEXTURE_2D, _placeholderTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_TEXEL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+void TextureCache::startDecoding(Entry& entry)
+{
+    entry.state = State::Decoding;
+    entry.quality = getTextureQuality();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _numDecoding++;
+    }
+
+    const auto entryPtr = &entry;
+    _threadPool.enqueue([this, entryPtr]
+    {
+        auto& entry = *entryPtr;
+        const auto isPacked = !entry.specularPath.empty();
+        auto numComponents = 0;
+        // Duplicates load nothing, draws get the original's texture
+        if (findOriginal(entry) == nullptr)
+        {
+            if (entry.cookedTexture.open(isPacked ? getPackedTexturePath(entry.path) : getCookedTexturePath(entry.path)))
+            {
+                // Cooked levels are uploaded straight from the mapping
+                entry.format = entry.cookedTexture.getFormat();
+                numComponents = entry.format.numComponents;
+                for (auto level = getFirstCookedMipLevel(entry.cookedTexture, entry.quality); level < entry.cookedTexture.getNumMipLevels(); level++) {
+                    entry.mipLevels.push_back(entry.cookedTexture.getMipLevel(level));
+                }
+            }
+            else
+            {
+                // Mips are filtered at 8 bits per component, then every level is converted to the format all of them fit
+                if (isPacked)
+                {
+                    std::vector<unsigned char> pixels;
+                    int width, height;
+                    if (decodePackedMaterial(entry.path, entry.specularPath, entry.quality, pixels, width, height))
+                    {
+                        numComponents = 4;
+                        entry.decodedLevels = generateMipChain(pixels.data(), width, height, numComponents);
+                    }
+                }
+                else
+                {
+                    DecodedImage image;
+                    image.quality = entry.quality;
+                    if (decodeImage(entry.path, image))
+                    {
+                        numComponents = image.numComponents;
+                        entry.decodedLevels = generateMipChain(image.pixels, image.width, image.height, numComponents);
+                        freeDecodedImage(image);
+                    }
+                }
+
+                if (!entry.decodedLevels.empty()) {
+                    entry.format = chooseMinimalFormat(analyzeMipChain(entry.decodedLevels, numComponents), numComponents);
+                }
+                for (auto& decodedLevel : entry.decodedLevels)
+                {
+                    const auto numPixels = static_cast<size_t>(decodedLevel.width) * decodedLevel.height;
+                    convertToFormat(decodedLevel.data.data(), numPixels, numComponents, entry.format, decodedLevel.data.data());
+                    decodedLevel.data.resize(numPixels * getBytesPerPixel(entry.format));
+
+                    TextureMipLevel mipLevel;
+                    mipLevel.width = decodedLevel.width;
+                    mipLevel.height = decodedLevel.height;
+                    mipLevel.data = decodedLevel.data.data();
+                    mipLevel.size = decodedLevel.data.size();
+                    entry.mipLevels.push_back(mipLevel);
+                }
+            }
+        }
+
+        // Cooked textures only know the components they store, so their savings count against those
+        entry.textureBytes = 0;
+        entry.uncompressedBytes = 0;
+        for (const auto& mipLevel : entry.mipLevels)
+        {
+            entry.textureBytes += mipLevel.size;
+            entry.uncompressedBytes += static_cast<size_t>(mipLevel.width) * mipLevel.height * numComponents;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _decodedEntries.push_back(entryPtr);
+        _numDecoding--;
+        _entryDecoded.notify_all();
+    });
+}
+
+TextureCache::Entry* TextureCache::findOriginal(Entry& entry)
+{
+    // A file that can't be read is reported by decoding
+    MappedFile file, specularFile;
+    if (!file.open(entry.path) || (!entry.specularPath.empty() && !specularFile.open(entry.specularPath))) {
+        return nullptr;
+    }
+
+    // Identical files under different names share a texture, the hash only finds candidates
+    auto contentHash = hashContents(file);
+    if (specularFile.isOpen()) {
+        contentHash = contentHash * 31 + hashContents(specularFile);
+    }
+    std::lock_guard<std::mutex> lock(_sharingMutex);
+    const auto candidates = _entriesByContentHash.equal_range(contentHash);
+    for (auto it = candidates.first; it != candidates.second; ++it)
+    {
+        // Released entries may be unloaded any time, duplicates have no texture of their own
+        auto& candidate = *it->second;
+        if (&candidate != &entry && candidate.numReferences > 0 && candidate.original == nullptr
+            && candidate.specularPath.empty() == entry.specularPath.empty() && hasContents(candidate.path, file)
+            && (entry.specularPath.empty() || hasContents(candidate.specularPath, specularFile)))
+        {
+            candidate.numReferences++;
+            entry.original = &candidate;
+            return &candidate;
+        }
+    }
+
+    if (!entry.isHashed)
+    {
+        _entriesByContentHash.emplace(contentHash, &entry);
+        entry.isHashed = true;
+    }
+    return nullptr;
+}
+
+void TextureCache::releaseReference(Entry& entry)
+{
+    {
+        std::lock_guard<std::mutex> lock(_sharingMutex);
+        if (entry.numReferences == 0 || --entry.numReferences > 0) {
+            return;
+        }
+    }
+
+    // Entries being decoded are unloaded once their worker is done, see update
+    if (entry.state != State::Decoding) {
+        unloadEntry(entry);
+    }
+}
+
+void TextureCache::unloadEntry(Entry& entry)
+{
+    if (entry.state != State::Shared)
+    {
+        releaseTexture(entry);
+        return;
+    }
+
+    // Registering the duplicate again looks for its original anew
+    Entry* original;
+    {
+        std::lock_guard<std::mutex> lock(_sharingMutex);
+        original = entry.original;
+        entry.original = nullptr;
+    }
+    entry.state = State::Unloaded;
+    releaseReference(*original);
+}
+
+void TextureCache::uploadLevels(size_t uploadBudget)
+{
+    if (_uploadingEntries.empty()) {
+        return;
+    }
+    if (!_stagingRing) {
+        _stagingRing.reset(new PixelUnpackRing(STAGING_RING_SIZE));
+    }
+
+    // Smallest levels of all textures go first, so that every requested texture shows up quickly
+    size_t uploadedBytes = 0;
+    auto isRingFull = false;
+    while (!isRingFull && uploadedBytes < uploadBudget)
+    {
+        Entry* nextEntry = nullptr;
+        size_t nextLevelSize = 0;
+        for (auto entry : _uploadingEntries)
+        {
+            const auto& mipLevel = entry->mipLevels[entry->mipLevels.size() - 1 - entry->numUploadedLevels];
+            if (nextEntry == nullptr || mipLevel.size < nextLevelSize)
+            {
+                nextEntry = entry;
+                nextLevelSize = mipLevel.size;
+            }
+        }
+        if (nextEntry == nullptr) {
+            break;
+        }
+        // Always upload at least one level per frame, so that a small budget still makes progress
+        if (uploadedBytes > 0 && uploadedBytes + nextLevelSize > uploadBudget) {
+            break;
+        }
+
+        auto& entry = *nextEntry;
+        const auto numMipLevels = static_cast<int>(entry.mipLevels.size());
+        const auto level = numMipLevels - 1 - entry.numUploadedLevels;
+        if (entry.textureID == 0)
+        {
+            glGenTextures(1, &entry.textureID);
+            glBindTexture(GL_TEXTURE_2D, entry.textureID);
+            setDefaultTextureParameters(entry.format.numComponents);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numMipLevels - 1);
+        }
+        else {
+            glBindTexture(GL_TEXTURE_2D, entry.textureID);
+        }
+
+        if (!uploadMipLevel(*_stagingRing, entry.format, level, entry.mipLevels[level], false))
+        {
+            isRingFull = true;
+            continue;
+        }
+
+        // Levels from the base level up are all present, so the texture stays complete
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        entry.numUploadedLevels++;
+        entry.residentBytes += nextLevelSize;
+        _residentBytes += nextLevelSize;
+        uploadedBytes += nextLevelSize;
+
+        if (entry.numUploadedLevels == numMipLevels)
+        {
+            // Everything is on the GPU, CPU copies are not needed anymore
+            entry.state = State::Resident;
+            entry.mipLevels.clear();
+            entry.decodedLevels.clear();
+            entry.decodedLevels.shrink_to_fit();
+            entry.cookedTexture.close();
+            _uploadingEntries.erase(std::find(_uploadingEntries.begin(), _uploadingEntries.end(), &entry));
+        }
+    }
+
+    _stagingRing->fence();
+    PixelUnpackRing::unbind();
+}
+
+void TextureCache::evictUnusedTextures()
+{
+    if (_residentBytes <= _vramBudget) {
+        return;
+    }
+
+    // Textures used in the previous frame are still needed, anything older may go
+    std::vector<Entry*> candidates;
+    for (const auto& entry : _entries)
+    {
+        if ((entry->state == State::Resident || entry->state == State::Uploading) && entry->lastUsedFrame + 1 < _frame) {
+            candidates.push_back(entry.get());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Entry* first, const Entry* second) {
+        return first->lastUsedFrame < second->lastUsedFrame;
+    });
+
+    for (auto entry : candidates)
+    {
+        if (_residentBytes <= _vramBudget) {
+            break;
+        }
+        releaseTexture(*entry);
+    }
+}
+
+void TextureCache::releaseTexture(Entry& entry)
+{
+    if (entry.textureID != 0)
+    {
+        glDeleteTextures(1, &entry.textureID);
+        entry.textureID = 0;
+    }
+
+    const auto it = std::find(_uploadingEntries.begin(), _uploadingEntries.end(), &entry);
+    if (it != _uploadingEntries.end()) {
+        _uploadingEntries.erase(it);
+    }
+
+    _residentBytes -= entry.residentBytes;
+    entry.residentBytes = 0;
+    entry.numUploadedLevels = 0;
+    entry.mipLevels.clear();
+    entry.decodedLevels.clear();
+    entry.decodedLevels.shrink_to_fit();
+    entry.cookedTexture.close();
+    entry.state = State::Unloaded;
+}
+
+void TextureCache::reportSavings() const
+{
+    std::cout << "Texture cache holds " << getNumResident() << " textures in " << _residentBytes / (1024.0 * 1024.0) << " MB:" << std::endl;
+    size_t totalSavedBytes = 0;
+    size_t sharedBytes = 0;
+    for (const auto& entry : _entries)
+    {
+        if (entry->state == State::Shared)
+        {
+            std::cout << "  " << std::left << std::setw(28) << entry->path << std::right << " same contents as " << entry->original->path << std::endl;
+            continue;
+        }
+        if (entry->state != State::Resident) {
+            continue;
+        }
+
+        // VRAM saved against the 8-bit format with the same number of components, mip levels included
+        const auto savedBytes = entry->uncompressedBytes - std::min(entry->textureBytes, entry->uncompressedBytes);
+        std::cout << "  " << std::left << std::setw(28) << entry->path << std::right << " " << std::setw(9) << getInternalFormatName(entry->format.internalFormat)
+            << std::fixed << std::setprecision(2) << ", " << std::setw(8) << entry->textureBytes / 1024.0 << " KB, saved " << std::setw(8) << savedBytes / 1024.0 << " KB"
+            << (entry->specularPath.empty() ? "" : " (specular packed)") << std::defaultfloat;
+        if (entry->numHits > 0) {
+            std::cout << " shared by " << entry->numHits + 1 << " handles";
+        }
+        std::cout << std::endl;
+        totalSavedBytes += savedBytes;
+        // Every hit would have loaded the texture once more
+        sharedBytes += entry->numHits * entry->textureBytes;
+    }
+
+    std::cout << "Minimal and compressed formats saved " << totalSavedBytes / (1024.0 * 1024.0) << " MB of VRAM" << std::endl;
+    const auto numHits = _numPathHits + _numContentHits;
+    std::cout << "Texture sharing: " << _numRequests << " registrations, " << _numPathHits << " path hits, " << _numContentHits
+        << " content hits (" << 100.0 * numHits / std::max(_numRequests, 1) << "% hit rate), saved "
+        << sharedBytes / (1024.0 * 1024.0) << " MB of VRAM" << std::endl;
+}
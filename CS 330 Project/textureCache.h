@@ -0,0 +1,170 @@
+#pragma once
+// STL
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+// Project
+#include "threadPool.h"
+#include "cookedTexture.h"
+#include "pixelUnpackRing.h"
+#include "textureLoader.h"
+
+/**
+ * Handle of a texture in the texture cache. Cheap to copy, valid as long as the cache exists.
+ */
+struct TextureHandle
+{
+    int index = -1; // Index of the texture in the cache, -1 for no texture
+};
+
+/**
+ * Textures loaded on demand. Registering a texture loads nothing, its image is decoded the first
+ * time a draw uses the texture. Until then, draws get a 1x1 placeholder. Mip levels are uploaded
+ * from the smallest to the largest, each one widening the texture's base level, so the texture
+ * sharpens progressively while it streams in. When resident textures exceed the VRAM budget,
+ * textures unused for the longest time are evicted (and loaded again, if they are used again).
+ *
+ * Textures are shared and reference counted. Registering a path again returns the same handle.
+ * A texture whose files have the contents of another one (found on the pool by a hash of the
+ * files, confirmed byte by byte) isn't decoded or uploaded, draws get the other one's texture.
+ */
+class TextureCache
+{
+public:
+    /**
+     * @param threadPool  Pool the images are decoded on
+     * @param vramBudget  Maximum size of resident textures in bytes
+     */
+    TextureCache(ThreadPool& threadPool, size_t vramBudget);
+
+    /**
+     * Waits for decoding still in progress and deletes all textures.
+     */
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    /**
+     * Registers texture without loading it and takes a reference to it. Registering the same path
+     * again returns the same handle.
+     *
+     * @param path  Path to the image file (a cooked container is used, if it exists)
+     */
+    TextureHandle getHandle(const std::string& path);
+
+    /**
+     * Registers material packed into one texture without loading it and takes a reference to it: the diffuse map in RGB and the
+     * luma of the specular map in alpha (for shaders compiled with PACKED_SPECULAR defined).
+     * The packed cooked container is used, if it exists, the images are decoded and packed otherwise.
+     *
+     * @param diffusePath   Path to the diffuse map
+     * @param specularPath  Path to the specular map
+     */
+    TextureHandle getPackedHandle(const std::string& diffusePath, const std::string& specularPath);
+
+    /**
+     * Drops reference taken by getHandle / getPackedHandle. With the last reference, the texture is
+     * unloaded (once its decoding is done, if it is in progress), registering it again loads it anew.
+     * GL thread only.
+     */
+    void release(TextureHandle handle);
+
+    /**
+     * Gets texture to bind for a draw. Marks the texture as used in this frame and starts loading it,
+     * if it is not resident. GL thread only.
+     *
+     * @return OpenGL texture ID, or the placeholder texture until the first mip level is uploaded.
+     */
+    GLuint use(TextureHandle handle);
+
+    /**
+     * Starts new frame: uploads decoded mip levels (at most uploadBudget bytes, smallest levels first)
+     * and evicts least recently used textures while over the VRAM budget. Call once per frame (GL thread only).
+     * The first time all registered textures are resident (or failed), prints VRAM saved by their formats
+     * and by sharing.
+     */
+    void update(size_t uploadBudget);
+
+    /**
+     * Gets total size of resident texture data in bytes.
+     */
+    size_t getResidentBytes() const;
+
+    /**
+     * Gets number of textures with at least one mip level resident.
+     */
+    int getNumResident() const;
+
+private:
+    enum class State
+    {
+        Unloaded, // Nothing loaded, draws get the placeholder
+        Decoding, // Image is being decoded on the thread pool (owned by the worker)
+        Uploading, // Decoded, mip levels are being uploaded
+        Resident, // All mip levels uploaded, CPU copy released
+        Failed, // Image could not be loaded, draws get the placeholder for good
+        Shared // Files have the contents of another entry, draws get its texture
+    };
+
+    struct Entry
+    {
+        std::string path;
+        std::string specularPath; // Specular map packed into alpha, empty for plain textures
+        State state = State::Unloaded;
+        GLuint textureID = 0;
+        CookedTexture cookedTexture; // Open, if the image has been cooked
+        std::vector<CookedMipLevelData> decodedLevels; // Mip chain of a decoded image
+        std::vector<TextureMipLevel> mipLevels; // Levels to upload, pointing to either of the above
+        CookedTextureFormat format;
+        TextureQuality quality = TextureQuality::Full; // Quality the texture is being loaded at, captured when decoding starts
+        int numUploadedLevels = 0; // Uploaded levels, counted from the smallest one
+        size_t residentBytes = 0; // Size of uploaded levels
+        size_t textureBytes = 0; // Size of all levels to upload
+        size_t uncompressedBytes = 0; // Size the levels would have at 8 bits per component
+        uint64_t lastUsedFrame = 0;
+        Entry* original = nullptr; // Entry with identical files, set on the pool if this one is a duplicate (guarded by sharing mutex)
+        bool isHashed = false; // Flag telling, if the entry is in the content hash map (guarded by sharing mutex)
+        std::atomic<int> numReferences{ 1 }; // Registrations (and duplicates) not released yet, changed under sharing mutex
+        int numHits = 0; // Registrations and duplicates served by this texture without loading anything
+    };
+
+    ThreadPool& _threadPool; // Pool the images are decoded on
+    size_t _vramBudget; // Maximum size of resident textures
+    GLuint _placeholderTexture = 0; // 1x1 texture served until a texture is uploaded
+    std::vector<std::unique_ptr<Entry>> _entries; // All registered textures
+    std::unordered_map<std::string, int> _indicesByPath; // Entry index of every registered path (or pair of packed paths)
+    std::unordered_multimap<uint64_t, Entry*> _entriesByContentHash; // Entries by hash of their files (guarded by sharing mutex)
+    int _numRequests = 0; // Number of registrations
+    int _numPathHits = 0; // Registrations of a path registered before
+    int _numContentHits = 0; // Entries found to have the contents of another one
+    std::vector<Entry*> _uploadingEntries; // Decoded entries being uploaded, in order of decoding (GL thread only)
+    std::vector<Entry*> _decodedEntries; // Entries decoded by workers, waiting for upload
+    int _numDecoding = 0; // Number of entries being decoded
+    std::unique_ptr<PixelUnpackRing> _stagingRing; // Created on first upload
+    uint64_t _frame = 1; // Current frame number
+    size_t _residentBytes = 0; // Total size of uploaded levels
+    bool _isSavingsReported = false; // Flag telling, if VRAM savings have been printed
+    mutable std::mutex _mutex; // Guards decoded entries and decoding count
+    std::mutex _sharingMutex; // Guards content hashes and references taken by the pool
+    std::condition_variable _entryDecoded; // Signalled whenever an entry gets decoded
+
+    TextureHandle registerEntry(const std::string& key, const std::string& path, const std::string& specularPath);
+    void createPlaceholderTexture();
+    void startDecoding(Entry& entry);
+    Entry* findOriginal(Entry& entry);
+    void releaseReference(Entry& entry);
+    void unloadEntry(Entry& entry);
+    void uploadLevels(size_t uploadBudget);
+    void evictUnusedTextures();
+    void releaseTexture(Entry& entry);
+    void reportSavings() const;
+};
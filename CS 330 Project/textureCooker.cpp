@@ -0,0 +1,395 @@
+// Offline texture cooker: converts source images (JPEG, PNG, GIF...) into cooked texture
+// containers with the full mip chain precomputed, see cookedTexture.h. Mip levels are
+// block-compressed by default (BC1 for color maps, BC3 for maps with alpha, BC4 for
+// greyscale maps such as specular maps), see blockCompression.h.
+//
+// Usage: TextureCooker [--uncompressed] <image> [<image> ...]
+// Every image is written next to its source as "<image>.ctex".
+//
+// TextureCooker [--uncompressed] --pack-specular <diffuse> <specular> [<diffuse> <specular> ...]
+// packs every material into one texture, the diffuse map with the luma of the specular map in
+// alpha (BC3 when compressed), written next to the diffuse map as "<diffuse>.packed.ctex".
+//
+// TextureCooker --benchmark <image> [<image> ...] cooks nothing, it measures decoding
+// throughput of every image read through stdio (stbi_load) against decoding straight
+// from a memory mapping of the file (the path the texture loader takes).
+//
+// TextureCooker --benchmark-png-filters measures PNG unfiltering throughput per filter
+// type, scalar against SSE2, on synthetic images.
+
+// STL
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <random>
+#include <cstdint>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Project
+#include "cookedTexture.h"
+#include "mappedFile.h"
+#include "blockCompression.h"
+#include "textureFormat.h"
+#include "threadPool.h"
+
+namespace {
+
+const int BENCHMARK_ITERATIONS = 20; // Decodes per image and input path
+const int FILTER_BENCHMARK_WIDTH = 2048; // Size of the synthetic PNGs of the filter benchmark
+const int FILTER_BENCHMARK_HEIGHT = 1024;
+
+/**
+ * Decodes image straight from a memory mapping of the file, which is unmapped right after.
+ */
+stbi_uc* loadMappedImage(const std::string& imagePath, int& width, int& height, int& numComponents)
+{
+    MappedFile file;
+    if (!file.open(imagePath) || file.getSize() > static_cast<size_t>(INT_MAX)) {
+        return nullptr;
+    }
+
+    file.adviseSequential();
+    return stbi_load_from_memory(file.getData(), static_cast<int>(file.getSize()), &width, &height, &numComponents, 0);
+}
+
+CookedTextureFormat getCompressedFormat(block_compression::BlockFormat blockFormat)
+{
+    CookedTextureFormat result;
+    result.numComponents = block_compression::getNumComponents(blockFormat);
+    result.internalFormat = block_compression::getInternalFormat(blockFormat);
+    result.isCompressed = true;
+    return result;
+}
+
+const char* getBlockFormatName(block_compression::BlockFormat blockFormat)
+{
+    switch (blockFormat)
+    {
+    case block_compression::BlockFormat::BC1:
+        return "BC1";
+    case block_compression::BlockFormat::BC3:
+        return "BC3";
+    case block_compression::BlockFormat::BC4:
+        return "BC4";
+    default:
+        return "BC5";
+    }
+}
+
+/**
+ * Cooks 8-bit image with full mip chain and writes it to given cooked container.
+ */
+bool cookPixels(const std::string& imagePath, const std::string& cookedPath, const unsigned char* pixels, int width, int height, int numComponents,
+    bool compress, ThreadPool& threadPool)
+{
+    const auto blockFormat = block_compression::chooseBlockFormat(pixels, width, height, numComponents);
+    auto mipLevels = generateMipChain(pixels, width, height, numComponents);
+
+    CookedTextureFormat format;
+    if (compress)
+    {
+        format = getCompressedFormat(blockFormat);
+        for (auto& mipLevel : mipLevels) {
+            mipLevel.data = block_compression::compressImage(blockFormat, mipLevel.data.data(), mipLevel.width, mipLevel.height, numComponents, &threadPool);
+        }
+    }
+    else
+    {
+        // Uncompressed levels are stored in the smallest format holding every level without loss
+        format = chooseMinimalFormat(analyzeMipChain(mipLevels, numComponents), numComponents);
+        for (auto& mipLevel : mipLevels)
+        {
+            const auto numPixels = static_cast<size_t>(mipLevel.width) * mipLevel.height;
+            convertToFormat(mipLevel.data.data(), numPixels, numComponents, format, mipLevel.data.data());
+            mipLevel.data.resize(numPixels * getBytesPerPixel(format));
+        }
+    }
+
+    if (!writeCookedTexture(cookedPath, format, mipLevels)) {
+        return false;
+    }
+
+    size_t totalBytes = 0;
+    for (const auto& mipLevel : mipLevels) {
+        totalBytes += mipLevel.data.size();
+    }
+    std::cout << "Cooked " << imagePath << " -> " << cookedPath << " (" << width << "x" << height << "x" << numComponents
+        << ", " << (compress ? getBlockFormatName(blockFormat) : getInternalFormatName(format.internalFormat)) << ", " << mipLevels.size() << " mip levels, " << totalBytes << " bytes)" << std::endl;
+    return true;
+}
+
+bool cookImage(const std::string& imagePath, bool compress, ThreadPool& threadPool)
+{
+    int width, height, numComponents;
+    const auto pixels = loadMappedImage(imagePath, width, height, numComponents);
+    if (pixels == nullptr)
+    {
+        std::cerr << "Could not load " << imagePath << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    const auto isCooked = cookPixels(imagePath, getCookedTexturePath(imagePath), pixels, width, height, numComponents, compress, threadPool);
+    stbi_image_free(pixels);
+    return isCooked;
+}
+
+/**
+ * Cooks material packed into one texture, see packMaterialImage.
+ */
+bool cookPackedMaterial(const std::string& diffusePath, const std::string& specularPath, bool compress, ThreadPool& threadPool)
+{
+    int diffuseWidth, diffuseHeight, diffuseComponents;
+    const auto diffusePixels = loadMappedImage(diffusePath, diffuseWidth, diffuseHeight, diffuseComponents);
+    if (diffusePixels == nullptr)
+    {
+        std::cerr << "Could not load " << diffusePath << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    int specularWidth, specularHeight, specularComponents;
+    const auto specularPixels = loadMappedImage(specularPath, specularWidth, specularHeight, specularComponents);
+    if (specularPixels == nullptr)
+    {
+        std::cerr << "Could not load " << specularPath << ": " << stbi_failure_reason() << std::endl;
+        stbi_image_free(diffusePixels);
+        return false;
+    }
+
+    const auto pixels = packMaterialImage(diffusePixels, diffuseWidth, diffuseHeight, diffuseComponents,
+        specularPixels, specularWidth, specularHeight, specularComponents);
+    stbi_image_free(diffusePixels);
+    stbi_image_free(specularPixels);
+    return cookPixels(diffusePath, getPackedTexturePath(diffusePath), pixels.data(), diffuseWidth, diffuseHeight, 4, compress, threadPool);
+}
+
+/**
+ * Decodes image repeatedly through both input paths and prints time per decode and throughput
+ * (file bytes per second). The file is in the page cache after the first decode, so both paths
+ * read from memory and only the way bytes reach the decoder differs.
+ */
+bool benchmarkImage(const std::string& imagePath)
+{
+    MappedFile file;
+    if (!file.open(imagePath))
+    {
+        std::cerr << "Could not open " << imagePath << std::endl;
+        return false;
+    }
+    const auto fileSize = file.getSize();
+    file.close();
+
+    const auto measure = [&](bool isMapped)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        for (auto i = 0; i < BENCHMARK_ITERATIONS; i++)
+        {
+            int width, height, numComponents;
+            const auto pixels = isMapped ? loadMappedImage(imagePath, width, height, numComponents)
+                : stbi_load(imagePath.c_str(), &width, &height, &numComponents, 0);
+            if (pixels == nullptr) {
+                return -1.0;
+            }
+            stbi_image_free(pixels);
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        return elapsed.count() / BENCHMARK_ITERATIONS;
+    };
+
+    // Warm up the page cache, so that neither path pays for the disk
+    measure(false);
+    const auto stdioMilliseconds = measure(false);
+    const auto mappedMilliseconds = measure(true);
+    if (stdioMilliseconds < 0.0 || mappedMilliseconds < 0.0)
+    {
+        std::cerr << "Could not load " << imagePath << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    const auto megabytes = fileSize / (1024.0 * 1024.0);
+    std::cout << imagePath << " (" << fileSize << " bytes): stdio " << stdioMilliseconds << " ms (" << megabytes / stdioMilliseconds * 1000.0
+        << " MB/s), mapped " << mappedMilliseconds << " ms (" << megabytes / mappedMilliseconds * 1000.0 << " MB/s), "
+        << stdioMilliseconds / mappedMilliseconds << "x" << std::endl;
+    return true;
+}
+
+void appendBigEndian(std::vector<unsigned char>& data, uint32_t value)
+{
+    data.push_back(static_cast<unsigned char>(value >> 24));
+    data.push_back(static_cast<unsigned char>(value >> 16));
+    data.push_back(static_cast<unsigned char>(value >> 8));
+    data.push_back(static_cast<unsigned char>(value));
+}
+
+void appendChunk(std::vector<unsigned char>& png, const char* type, const std::vector<unsigned char>& chunkData)
+{
+    appendBigEndian(png, static_cast<uint32_t>(chunkData.size()));
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), chunkData.begin(), chunkData.end());
+    appendBigEndian(png, 0); // CRC, not checked by stb_image
+}
+
+/**
+ * Builds 8-bit RGB or RGBA PNG in memory with every row using the same filter type. Rows hold random
+ * bytes (any bytes are valid filtered data) in stored (uncompressed) deflate blocks, so that decoding
+ * time is mostly unfiltering.
+ */
+std::vector<unsigned char> makeFilterBenchmarkPNG(int filterType, int numComponents)
+{
+    const auto rowSize = static_cast<size_t>(FILTER_BENCHMARK_WIDTH) * numComponents;
+    std::vector<unsigned char> rows;
+    std::mt19937 random(12345);
+    for (auto y = 0; y < FILTER_BENCHMARK_HEIGHT; y++)
+    {
+        rows.push_back(static_cast<unsigned char>(filterType));
+        for (size_t i = 0; i < rowSize; i++) {
+            rows.push_back(static_cast<unsigned char>(random()));
+        }
+    }
+
+    // zlib stream of stored blocks (at most 65535 bytes each)
+    std::vector<unsigned char> imageData = { 0x78, 0x01 };
+    for (size_t offset = 0; offset < rows.size(); offset += 65535)
+    {
+        const auto blockSize = static_cast<uint32_t>(std::min<size_t>(65535, rows.size() - offset));
+        imageData.push_back(offset + blockSize == rows.size() ? 1 : 0);
+        imageData.push_back(static_cast<unsigned char>(blockSize));
+        imageData.push_back(static_cast<unsigned char>(blockSize >> 8));
+        imageData.push_back(static_cast<unsigned char>(~blockSize));
+        imageData.push_back(static_cast<unsigned char>(~blockSize >> 8));
+        imageData.insert(imageData.end(), rows.begin() + offset, rows.begin() + offset + blockSize);
+    }
+    uint32_t adlerLow = 1, adlerHigh = 0;
+    for (const auto byte : rows)
+    {
+        adlerLow = (adlerLow + byte) % 65521;
+        adlerHigh = (adlerHigh + adlerLow) % 65521;
+    }
+    appendBigEndian(imageData, (adlerHigh << 16) | adlerLow);
+
+    std::vector<unsigned char> header;
+    appendBigEndian(header, FILTER_BENCHMARK_WIDTH);
+    appendBigEndian(header, FILTER_BENCHMARK_HEIGHT);
+    header.push_back(8); // Bit depth
+    header.push_back(numComponents == 4 ? 6 : 2); // Color type
+    header.push_back(0); // Compression
+    header.push_back(0); // Filter method
+    header.push_back(0); // No interlacing
+
+    std::vector<unsigned char> png = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", imageData);
+    appendChunk(png, "IEND", {});
+    return png;
+}
+
+/**
+ * Decodes synthetic PNGs using one filter type each with SIMD unfiltering turned off and on,
+ * and prints throughput in decoded megabytes per second.
+ */
+bool benchmarkPngFilters()
+{
+    const char* filterNames[] = { "None", "Sub", "Up", "Average", "Paeth" };
+    for (auto numComponents = 3; numComponents <= 4; numComponents++)
+    {
+        for (auto filterType = 0; filterType < 5; filterType++)
+        {
+            const auto png = makeFilterBenchmarkPNG(filterType, numComponents);
+            const auto measure = [&](bool useSimd)
+            {
+                stbi_set_png_simd_unfilter(useSimd ? 1 : 0);
+                const auto startTime = std::chrono::steady_clock::now();
+                for (auto i = 0; i < BENCHMARK_ITERATIONS; i++)
+                {
+                    int width, height, imageComponents;
+                    const auto pixels = stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &width, &height, &imageComponents, 0);
+                    if (pixels == nullptr) {
+                        return -1.0;
+                    }
+                    stbi_image_free(pixels);
+                }
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+                const auto megabytes = static_cast<double>(FILTER_BENCHMARK_WIDTH) * FILTER_BENCHMARK_HEIGHT * numComponents / (1024.0 * 1024.0);
+                return megabytes * BENCHMARK_ITERATIONS / elapsed.count();
+            };
+
+            const auto scalarThroughput = measure(false);
+            const auto simdThroughput = measure(true);
+            if (scalarThroughput < 0.0 || simdThroughput < 0.0)
+            {
+                std::cerr << "Could not decode benchmark image: " << stbi_failure_reason() << std::endl;
+                return false;
+            }
+            std::cout << filterNames[filterType] << (numComponents == 4 ? ", RGBA: " : ", RGB: ") << "scalar " << scalarThroughput
+                << " MB/s, SIMD " << simdThroughput << " MB/s, " << simdThroughput / scalarThroughput << "x" << std::endl;
+        }
+    }
+
+    stbi_set_png_simd_unfilter(1);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto compress = true;
+    auto benchmark = false;
+    auto packSpecular = false;
+    std::vector<std::string> imagePaths;
+    for (auto i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--uncompressed") {
+            compress = false;
+        }
+        else if (argument == "--benchmark") {
+            benchmark = true;
+        }
+        else if (argument == "--pack-specular") {
+            packSpecular = true;
+        }
+        else if (argument == "--benchmark-png-filters") {
+            return benchmarkPngFilters() ? 0 : 1;
+        }
+        else {
+            imagePaths.push_back(argument);
+        }
+    }
+
+    if (imagePaths.empty() || (packSpecular && imagePaths.size() % 2 != 0))
+    {
+        std::cout << "Usage: TextureCooker [--uncompressed] <image> [<image> ...]" << std::endl;
+        std::cout << "       TextureCooker [--uncompressed] --pack-specular <diffuse> <specular> [<diffuse> <specular> ...]" << std::endl;
+        std::cout << "       TextureCooker --benchmark <image> [<image> ...]" << std::endl;
+        std::cout << "       TextureCooker --benchmark-png-filters" << std::endl;
+        return 1;
+    }
+
+    ThreadPool threadPool;
+    auto numFailed = 0;
+    if (packSpecular)
+    {
+        for (size_t i = 0; i < imagePaths.size(); i += 2)
+        {
+            if (!cookPackedMaterial(imagePaths[i], imagePaths[i + 1], compress, threadPool)) {
+                numFailed++;
+            }
+        }
+        return numFailed == 0 ? 0 : 1;
+    }
+
+    for (const auto& imagePath : imagePaths)
+    {
+        const auto isDone = benchmark ? benchmarkImage(imagePath) : cookImage(imagePath, compress, threadPool);
+        if (!isDone) {
+            numFailed++;
+        }
+    }
+
+    return numFailed == 0 ? 0 : 1;
+}
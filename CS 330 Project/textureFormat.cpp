@@ -0,0 +1,313 @@
+// STL
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Project
+#include "textureFormat.h"
+#include "blockCompression.h"
+
+namespace {
+
+/**
+ * Quantizes 8-bit value to given maximum (31 or 63), rounding to nearest like the GL does.
+ */
+int quantize(int value, int maximum)
+{
+    return (value * maximum + 127) / 255;
+}
+
+/**
+ * Tables telling, which 8-bit values come back unchanged from 5 and 6 bits.
+ */
+struct QuantizationTables
+{
+    bool fits5[256];
+    bool fits6[256];
+
+    QuantizationTables()
+    {
+        for (auto value = 0; value < 256; value++)
+        {
+            fits5[value] = (quantize(value, 31) * 255 + 15) / 31 == value;
+            fits6[value] = (quantize(value, 63) * 255 + 31) / 63 == value;
+        }
+    }
+};
+
+/**
+ * Source pixels (and their weights) making up one target pixel along one axis.
+ */
+struct Contribution
+{
+    std::vector<int> sourceIndices;
+    std::vector<float> weights;
+};
+
+std::vector<Contribution> computeContributions(int sourceSize, int targetSize)
+{
+    std::vector<Contribution> result(targetSize);
+    const auto scale = static_cast<float>(sourceSize) / targetSize;
+    for (auto target = 0; target < targetSize; target++)
+    {
+        auto& contribution = result[target];
+        if (scale > 1.0f)
+        {
+            // Minification: weight every covered source pixel by how much of it is covered
+            const auto start = target * scale;
+            const auto end = (target + 1) * scale;
+            for (auto source = static_cast<int>(start); source < end && source < sourceSize; source++)
+            {
+                const auto coverage = std::min(end, source + 1.0f) - std::max(start, static_cast<float>(source));
+                contribution.sourceIndices.push_back(source);
+                contribution.weights.push_back(coverage / scale);
+            }
+        }
+        else
+        {
+            // Magnification: interpolate between the two nearest source pixels
+            const auto center = (target + 0.5f) * scale - 0.5f;
+            const auto first = static_cast<int>(std::floor(center));
+            const auto fraction = center - first;
+            contribution.sourceIndices.push_back(std::max(first, 0));
+            contribution.weights.push_back(1.0f - fraction);
+            contribution.sourceIndices.push_back(std::min(first + 1, sourceSize - 1));
+            contribution.weights.push_back(fraction);
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+ImageFormatAnalysis analyzeImage(const unsigned char* pixels, int width, int height, int numComponents)
+{
+    static const QuantizationTables tables;
+
+    ImageFormatAnalysis result;
+    const auto hasColor = numComponents >= 3;
+    const auto hasAlpha = numComponents == 2 || numComponents == 4;
+    // Greyscale images end up in GL_R8 / GL_RG8 anyway, 5-6-5 only matters for color images
+    result.fitsRGB565 = hasColor;
+
+    const auto numPixels = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < numPixels; i++)
+    {
+        const auto pixel = pixels + i * numComponents;
+        if (hasColor)
+        {
+            if (pixel[0] != pixel[1] || pixel[0] != pixel[2]) {
+                result.isGreyscale = false;
+            }
+            if (!tables.fits5[pixel[0]] || !tables.fits6[pixel[1]] || !tables.fits5[pixel[2]]) {
+                result.fitsRGB565 = false;
+            }
+        }
+        if (hasAlpha && pixel[numComponents - 1] != 255) {
+            result.isOpaque = false;
+        }
+
+        if (!result.isGreyscale && !result.isOpaque && !result.fitsRGB565) {
+            break;
+        }
+    }
+
+    return result;
+}
+
+ImageFormatAnalysis analyzeMipChain(const std::vector<CookedMipLevelData>& mipLevels, int numComponents)
+{
+    ImageFormatAnalysis result;
+    for (const auto& mipLevel : mipLevels)
+    {
+        const auto levelAnalysis = analyzeImage(mipLevel.data.data(), mipLevel.width, mipLevel.height, numComponents);
+        result.isGreyscale = result.isGreyscale && levelAnalysis.isGreyscale;
+        result.isOpaque = result.isOpaque && levelAnalysis.isOpaque;
+        result.fitsRGB565 = result.fitsRGB565 && levelAnalysis.fitsRGB565;
+        if (!result.isGreyscale && !result.isOpaque && !result.fitsRGB565) {
+            break;
+        }
+    }
+
+    return result;
+}
+
+CookedTextureFormat chooseMinimalFormat(const ImageFormatAnalysis& analysis, int numComponents)
+{
+    const auto hasAlpha = (numComponents == 2 || numComponents == 4) && !analysis.isOpaque;
+    if (analysis.isGreyscale) {
+        return getUncompressedFormat(hasAlpha ? 2 : 1);
+    }
+    if (hasAlpha) {
+        return getUncompressedFormat(4);
+    }
+
+    auto result = getUncompressedFormat(3);
+    if (analysis.fitsRGB565)
+    {
+        result.internalFormat = GL_RGB565;
+        result.type = GL_UNSIGNED_SHORT_5_6_5;
+    }
+
+    return result;
+}
+
+void convertToFormat(const unsigned char* pixels, size_t numPixels, int numComponents, const CookedTextureFormat& format, unsigned char* target)
+{
+    if (format.type == GL_UNSIGNED_SHORT_5_6_5)
+    {
+        for (size_t i = 0; i < numPixels; i++)
+        {
+            const auto pixel = pixels + i * numComponents;
+            const auto packed = static_cast<uint16_t>((quantize(pixel[0], 31) << 11) | (quantize(pixel[1], 63) << 5) | quantize(pixel[2], 31));
+            memcpy(target + i * 2, &packed, 2);
+        }
+        return;
+    }
+
+    if (format.numComponents == numComponents)
+    {
+        if (target != pixels) {
+            memmove(target, pixels, numPixels * numComponents);
+        }
+        return;
+    }
+
+    // Source channel of every stored component, grey images keep R (and alpha)
+    int channels[4] = { 0, 1, 2, 3 };
+    if (format.numComponents == 2) {
+        channels[1] = numComponents - 1;
+    }
+
+    const auto numTargetComponents = format.numComponents;
+    for (size_t i = 0; i < numPixels; i++)
+    {
+        // Pixel is read before it is written, so converting in place is safe
+        const auto pixel = pixels + i * numComponents;
+        unsigned char values[4];
+        for (auto c = 0; c < numTargetComponents; c++) {
+            values[c] = pixel[channels[c]];
+        }
+        memcpy(target + i * numTargetComponents, values, numTargetComponents);
+    }
+}
+
+size_t getBytesPerPixel(const CookedTextureFormat& format)
+{
+    return format.type == GL_UNSIGNED_SHORT_5_6_5 ? 2 : static_cast<size_t>(format.numComponents);
+}
+
+const char* getInternalFormatName(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_R8:
+        return "GL_R8";
+    case GL_RG8:
+        return "GL_RG8";
+    case GL_RGB8:
+        return "GL_RGB8";
+    case GL_RGBA8:
+        return "GL_RGBA8";
+    case GL_RGB565:
+        return "GL_RGB565";
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        return "BC1";
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return "BC3";
+    case GL_COMPRESSED_RED_RGTC1:
+        return "BC4";
+    case GL_COMPRESSED_RG_RGTC2:
+        return "BC5";
+    default:
+        return "unknown";
+    }
+}
+
+std::vector<unsigned char> resizeImageToRGB(const unsigned char* pixels, int width, int height, int numComponents, int targetWidth, int targetHeight)
+{
+    // Channels to read for R, G and B (grey and grey + alpha images replicate channel 0)
+    const int channels[3] = { 0, numComponents >= 3 ? 1 : 0, numComponents >= 3 ? 2 : 0 };
+    if (width == targetWidth && height == targetHeight)
+    {
+        // Images of the target size are only converted to RGB
+        const auto numPixels = static_cast<size_t>(width) * height;
+        std::vector<unsigned char> result(numPixels * 3);
+        for (size_t i = 0; i < numPixels; i++)
+        {
+            for (auto c = 0; c < 3; c++) {
+                result[i * 3 + c] = pixels[i * numComponents + channels[c]];
+            }
+        }
+        return result;
+    }
+
+    const auto columns = computeContributions(width, targetWidth);
+    const auto rows = computeContributions(height, targetHeight);
+
+    // Separable filter, horizontal pass first into floating point intermediate rows
+    std::vector<float> horizontal(static_cast<size_t>(targetWidth) * height * 3);
+    for (auto y = 0; y < height; y++)
+    {
+        const auto sourceRow = pixels + static_cast<size_t>(y) * width * numComponents;
+        auto targetRow = horizontal.data() + static_cast<size_t>(y) * targetWidth * 3;
+        for (auto x = 0; x < targetWidth; x++)
+        {
+            const auto& contribution = columns[x];
+            float sum[3] = { 0.0f, 0.0f, 0.0f };
+            for (size_t i = 0; i < contribution.sourceIndices.size(); i++)
+            {
+                const auto source = sourceRow + static_cast<size_t>(contribution.sourceIndices[i]) * numComponents;
+                for (auto c = 0; c < 3; c++) {
+                    sum[c] += source[channels[c]] * contribution.weights[i];
+                }
+            }
+            for (auto c = 0; c < 3; c++) {
+                targetRow[x * 3 + c] = sum[c];
+            }
+        }
+    }
+
+    std::vector<unsigned char> result(static_cast<size_t>(targetWidth) * targetHeight * 3);
+    for (auto y = 0; y < targetHeight; y++)
+    {
+        const auto& contribution = rows[y];
+        auto targetRow = result.data() + static_cast<size_t>(y) * targetWidth * 3;
+        for (auto x = 0; x < targetWidth * 3; x++)
+        {
+            auto sum = 0.0f;
+            for (size_t i = 0; i < contribution.sourceIndices.size(); i++) {
+                sum += horizontal[static_cast<size_t>(contribution.sourceIndices[i]) * targetWidth * 3 + x] * contribution.weights[i];
+            }
+            targetRow[x] = static_cast<unsigned char>(std::min(std::max(sum + 0.5f, 0.0f), 255.0f));
+        }
+    }
+
+    return result;
+}
+
+std::vector<unsigned char> packSpecularIntoAlpha(const std::vector<unsigned char>& diffuseRGB, const std::vector<unsigned char>& specularRGB)
+{
+    const auto numPixels = diffuseRGB.size() / 3;
+    std::vector<unsigned char> result(numPixels * 4);
+    for (size_t i = 0; i < numPixels; i++)
+    {
+        const auto specular = &specularRGB[i * 3];
+        result[i * 4 + 0] = diffuseRGB[i * 3 + 0];
+        result[i * 4 + 1] = diffuseRGB[i * 3 + 1];
+        result[i * 4 + 2] = diffuseRGB[i * 3 + 2];
+        // Rec. 601 luma in 8-bit fixed point, exact for grey pixels
+        result[i * 4 + 3] = static_cast<unsigned char>((77 * specular[0] + 150 * specular[1] + 29 * specular[2] + 128) >> 8);
+    }
+
+    return result;
+}
+
+std::vector<unsigned char> packMaterialImage(const unsigned char* diffusePixels, int diffuseWidth, int diffuseHeight, int diffuseComponents,
+    const unsigned char* specularPixels, int specularWidth, int specularHeight, int specularComponents)
+{
+    return packSpecularIntoAlpha(resizeImageToRGB(diffusePixels, diffuseWidth, diffuseHeight, diffuseComponents, diffuseWidth, diffuseHeight),
+        resizeImageToRGB(specularPixels, specularWidth, specularHeight, specularComponents, diffuseWidth, diffuseHeight));
+}
@@ -0,0 +1,87 @@
+#pragma once
+// STL
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Project
+#include "cookedTexture.h"
+
+/**
+ * Properties of an 8-bit image that decide how small its texture can be stored without loss.
+ */
+struct ImageFormatAnalysis
+{
+    bool isGreyscale = true; // R, G and B are equal in every pixel (always true for 1 and 2 component images)
+    bool isOpaque = true; // Alpha is 255 in every pixel (always true for 1 and 3 component images)
+    bool fitsRGB565 = true; // Every R, G and B comes back unchanged from 5, 6 and 5 bits (at 8-bit precision)
+};
+
+/**
+ * Analyzes tightly packed 8-bit image. Stops reading pixels as soon as no property can hold anymore.
+ */
+ImageFormatAnalysis analyzeImage(const unsigned char* pixels, int width, int height, int numComponents);
+
+/**
+ * Analyzes every level of a mip chain (see generateMipChain). Filtered levels mix neighbouring
+ * colors, so they may no longer fit a format their base level fits (e.g. GL_RGB565).
+ */
+ImageFormatAnalysis analyzeMipChain(const std::vector<CookedMipLevelData>& mipLevels, int numComponents);
+
+/**
+ * Picks smallest uncompressed format holding an image with given properties without loss:
+ * GL_R8 / GL_RG8 for greyscale images (without / with alpha), GL_RGB565 for low dynamic range
+ * color images, the 8-bit format with the same number of components otherwise. Constant opaque
+ * alpha is dropped. The format's numComponents is the number of stored components, so the
+ * usual swizzle makes greyscale formats sample as grey again.
+ */
+CookedTextureFormat chooseMinimalFormat(const ImageFormatAnalysis& analysis, int numComponents);
+
+/**
+ * Converts tightly packed 8-bit pixels to a format chosen by chooseMinimalFormat.
+ * Target may be the same memory as the pixels, the converted image is never larger.
+ *
+ * @param pixels         Source pixels
+ * @param numPixels      Number of pixels to convert
+ * @param numComponents  Number of components per source pixel
+ * @param format         Target format
+ * @param target         Where to write converted pixels (numPixels * getBytesPerPixel(format) bytes)
+ */
+void convertToFormat(const unsigned char* pixels, size_t numPixels, int numComponents, const CookedTextureFormat& format, unsigned char* target);
+
+/**
+ * Gets size of one pixel of an uncompressed format in bytes.
+ */
+size_t getBytesPerPixel(const CookedTextureFormat& format);
+
+/**
+ * Gets name of an internal format for reports (e.g. "GL_RGB565").
+ */
+const char* getInternalFormatName(GLenum internalFormat);
+
+/**
+ * Resizes 8-bit image and converts it to RGB. Minification averages all covered source
+ * pixels (box filter), magnification interpolates bilinearly. Grey images are replicated
+ * to all three channels, alpha is dropped.
+ *
+ * @return Resized RGB pixels, tightly packed.
+ */
+std::vector<unsigned char> resizeImageToRGB(const unsigned char* pixels, int width, int height, int numComponents, int targetWidth, int targetHeight);
+
+/**
+ * Packs specular map into the alpha channel of a diffuse map. Both images are RGB of the same size,
+ * specular intensity is the luma of the specular map (specular maps are greyscale anyway).
+ *
+ * @return RGBA pixels, tightly packed.
+ */
+std::vector<unsigned char> packSpecularIntoAlpha(const std::vector<unsigned char>& diffuseRGB, const std::vector<unsigned char>& specularRGB);
+
+/**
+ * Packs a material into one RGBA image of the diffuse map's size: diffuse color in RGB and specular
+ * intensity in alpha. The specular map is resized to the diffuse map's size, if the sizes differ.
+ *
+ * @return RGBA pixels, tightly packed.
+ */
+std::vector<unsigned char> packMaterialImage(const unsigned char* diffusePixels, int diffuseWidth, int diffuseHeight, int diffuseComponents,
+    const unsigned char* specularPixels, int specularWidth, int specularHeight, int specularComponents);
@@ -0,0 +1,729 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <climits>
+
+// Project
+#include "textureLoader.h"
+#include "mappedFile.h"
+#include "textureFormat.h"
+#include "stb_image.h"
+
+namespace {
+
+const size_t STAGING_RING_SIZE = 16 * 1024 * 1024; // Staging memory for streamed uploads
+
+std::atomic<int> textureQuality(static_cast<int>(TextureQuality::Full)); // Read by decoding threads
+
+/**
+ * Runs tasks of the JPEG decoder on the pool given as user data. The calling thread helps,
+ * so decodes already running on the pool can split their work without deadlocking.
+ */
+void parallelForOnPool(void* user, int count, stbi_parallel_task task, void* taskData)
+{
+    static_cast<ThreadPool*>(user)->parallelFor(count, [task, taskData](int i) { task(taskData, i); });
+}
+
+/**
+ * Decodes image from a mapped file, in the 8-bit format matching its number of components.
+ */
+bool decodeMappedImage(const MappedFile& file, DecodedImage& image)
+{
+    if (!file.isOpen() || file.getSize() > static_cast<size_t>(INT_MAX)) {
+        return false;
+    }
+
+    // The quality doubles as the log2 of the JPEG downscale factor, set for this thread's decodes only
+    stbi_set_jpeg_downscale_on_load_thread(static_cast<int>(image.quality));
+    image.pixels = stbi_load_from_memory(file.getData(), static_cast<int>(file.getSize()), &image.width, &image.height, &image.numComponents, 0);
+    image.format = getUncompressedFormat(image.numComponents);
+    return image.pixels != nullptr;
+}
+
+/**
+ * Gets size of a texture with full mip chain (down to 1x1) in bytes.
+ */
+size_t getMipChainSize(int width, int height, size_t bytesPerPixel)
+{
+    size_t result = 0;
+    for (;;)
+    {
+        result += static_cast<size_t>(width) * height * bytesPerPixel;
+        if (width == 1 && height == 1) {
+            return result;
+        }
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+}
+
+void setDefaultSamplingParameters()
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+/**
+ * Makes textures with fewer than 3 components sample like the greyscale images they come from,
+ * because shaders read material maps as vec3 (single-channel specular maps would be red otherwise).
+ */
+void setComponentSwizzle(int numComponents)
+{
+    if (numComponents == 1)
+    {
+        const GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+    else if (numComponents == 2)
+    {
+        const GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+}
+
+} // namespace
+
+void setTextureQuality(TextureQuality quality)
+{
+    textureQuality = static_cast<int>(quality);
+}
+
+TextureQuality getTextureQuality()
+{
+    return static_cast<TextureQuality>(textureQuality.load());
+}
+
+void setDecodeThreadPool(ThreadPool* threadPool)
+{
+    stbi_set_jpeg_parallel_for(threadPool != nullptr ? parallelForOnPool : nullptr, threadPool);
+}
+
+int getFirstCookedMipLevel(const CookedTexture& cookedTexture, TextureQuality quality)
+{
+    return std::min(static_cast<int>(quality), cookedTexture.getNumMipLevels() - 1);
+}
+
+bool decodeImage(const std::string& path, DecodedImage& image)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    image.path = path;
+    // Decoding straight from a mapping of the file skips the stdio buffer and its copies,
+    // the mapping is gone again as soon as the image is decoded
+    MappedFile file;
+    if (file.open(path))
+    {
+        file.adviseSequential();
+        decodeMappedImage(file, image);
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    image.decodeMilliseconds = elapsed.count();
+    return image.pixels != nullptr;
+}
+
+void convertToMinimalFormat(DecodedImage& image)
+{
+    if (image.pixels == nullptr) {
+        return;
+    }
+
+    const auto analysis = analyzeImage(image.pixels, image.width, image.height, image.format.numComponents);
+    const auto format = chooseMinimalFormat(analysis, image.format.numComponents);
+    convertToFormat(image.pixels, static_cast<size_t>(image.width) * image.height, image.format.numComponents, format, image.pixels);
+    image.format = format;
+}
+
+void freeDecodedImage(DecodedImage& image)
+{
+    stbi_image_free(image.pixels);
+    image.pixels = nullptr;
+}
+
+void uploadDecodedImage(GLuint textureID, const DecodedImage& image)
+{
+    if (image.pixels == nullptr)
+    {
+        std::cout << "Texture failed to load at path: " << image.path << std::endl;
+        return;
+    }
+
+    const auto& format = image.format;
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    // Rows are tightly packed, which matters for 1 and 3 component images with odd widths
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, image.width, image.height, 0, format.format, format.type, image.pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    setDefaultTextureParameters(format.numComponents);
+}
+
+void uploadCookedTexture(GLuint textureID, const CookedTexture& cookedTexture, TextureQuality quality)
+{
+    const auto& format = cookedTexture.getFormat();
+    // Levels skipped at lower quality are never touched, the first loaded level becomes level 0
+    const auto firstLevel = getFirstCookedMipLevel(cookedTexture, quality);
+    const auto numMipLevels = cookedTexture.getNumMipLevels() - firstLevel;
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (auto level = 0; level < numMipLevels; level++)
+    {
+        const auto mipLevel = cookedTexture.getMipLevel(firstLevel + level);
+        if (format.isCompressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, mipLevel.width, mipLevel.height, 0, static_cast<GLsizei>(mipLevel.size), mipLevel.data);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, mipLevel.width, mipLevel.height, 0, format.format, format.type, mipLevel.data);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numMipLevels - 1);
+    setDefaultTextureParameters(format.numComponents);
+}
+
+void setDefaultTextureParameters(int numComponents)
+{
+    setDefaultSamplingParameters();
+    setComponentSwizzle(numComponents);
+}
+
+bool uploadMipLevel(PixelUnpackRing& stagingRing, const CookedTextureFormat& format, int level, const TextureMipLevel& mipLevel, bool waitForSpace)
+{
+    const void* pixels = nullptr;
+    const auto data = stagingRing.map(mipLevel.size, waitForSpace);
+    if (data != nullptr)
+    {
+        memcpy(data, mipLevel.data, mipLevel.size);
+        pixels = reinterpret_cast<const void*>(stagingRing.unmap());
+    }
+    else if (mipLevel.size > stagingRing.getSize())
+    {
+        // Level too large for the ring, upload it straight from memory
+        PixelUnpackRing::unbind();
+        pixels = mipLevel.data;
+    }
+    else {
+        return false;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (format.isCompressed) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, mipLevel.width, mipLevel.height, 0, static_cast<GLsizei>(mipLevel.size), pixels);
+    }
+    else {
+        glTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, mipLevel.width, mipLevel.height, 0, format.format, format.type, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return true;
+}
+
+TextureLoader::TextureLoader(ThreadPool& threadPool)
+    : _threadPool(threadPool) {}
+
+TextureLoader::~TextureLoader()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _requestDecoded.wait(lock, [this] { return static_cast<int>(_decodedRequests.size()) >= _numPending; });
+    for (auto textureRequest : _decodedRequests) {
+        freeDecodedImage(textureRequest->image);
+    }
+    for (auto textureRequest : _streamingRequests) {
+        freeDecodedImage(textureRequest->image);
+    }
+}
+
+GLuint TextureLoader::request(const std::string& path)
+{
+    if (_requests.empty()) {
+        _firstRequestTime = std::chrono::steady_clock::now();
+    }
+    _numRequests++;
+
+    const auto pathIt = _requestsByPath.find(path);
+    if (pathIt != _requestsByPath.end())
+    {
+        _numPathHits++;
+        return addReference(*pathIt->second);
+    }
+
+    // The file is only read on the pool, files with the contents of another one are found there
+    std::unique_ptr<TextureRequest> textureRequest(new TextureRequest);
+    glGenTextures(1, &textureRequest->textureID);
+    textureRequest->image.path = path;
+
+    const auto requestPtr = textureRequest.get();
+    _requests.push_back(std::move(textureRequest));
+    _requestsByPath[path] = requestPtr;
+    _requestsByTexture[requestPtr->textureID] = requestPtr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _numPending++;
+    }
+
+    _threadPool.enqueue([this, requestPtr]
+    {
+        auto& image = requestPtr->image;
+        const auto startTime = std::chrono::steady_clock::now();
+        MappedFile file;
+        if (file.open(image.path))
+        {
+            file.adviseSequential();
+            requestPtr->original = findOriginal(*requestPtr, file);
+        }
+        if (requestPtr->original == nullptr) {
+            requestPtr->isCooked = requestPtr->cookedTexture.open(getCookedTexturePath(image.path));
+        }
+
+        if (requestPtr->original != nullptr)
+        {
+            // Nothing to load, the texture is redirected to the original once it reaches the GL thread
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+            image.decodeMilliseconds = elapsed.count();
+        }
+        else if (requestPtr->isCooked)
+        {
+            // Nothing to decode, mapping the file is all the work
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+            image.width = requestPtr->cookedTexture.getWidth();
+            image.height = requestPtr->cookedTexture.getHeight();
+            image.numComponents = requestPtr->cookedTexture.getFormat().numComponents;
+            image.format = requestPtr->cookedTexture.getFormat();
+            image.decodeMilliseconds = elapsed.count();
+            const auto& cookedTexture = requestPtr->cookedTexture;
+            for (auto level = getFirstCookedMipLevel(cookedTexture, image.quality); level < cookedTexture.getNumMipLevels(); level++)
+            {
+                const auto mipLevel = cookedTexture.getMipLevel(level);
+                requestPtr->textureBytes += mipLevel.size;
+                requestPtr->uncompressedBytes += static_cast<size_t>(mipLevel.width) * mipLevel.height * image.numComponents;
+            }
+        }
+        else if (decodeMappedImage(file, image))
+        {
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+            image.decodeMilliseconds = elapsed.count();
+            convertToMinimalFormat(image);
+            requestPtr->textureBytes = getMipChainSize(image.width, image.height, getBytesPerPixel(image.format));
+            requestPtr->uncompressedBytes = getMipChainSize(image.width, image.height, image.numComponents);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _decodedRequests.push_back(requestPtr);
+        _requestDecoded.notify_all();
+    });
+
+    return requestPtr->textureID;
+}
+
+GLuint TextureLoader::getTexture(GLuint textureID) const
+{
+    const auto it = _requestsByTexture.find(textureID);
+    if (it == _requestsByTexture.end()) {
+        return textureID;
+    }
+
+    const auto& textureRequest = *it->second;
+    return textureRequest.isUploaded && textureRequest.original != nullptr ? textureRequest.original->textureID : textureID;
+}
+
+void TextureLoader::release(GLuint textureID)
+{
+    const auto it = _requestsByTexture.find(textureID);
+    if (it != _requestsByTexture.end()) {
+        releaseRequest(*it->second);
+    }
+}
+
+void TextureLoader::releaseRequest(TextureRequest& textureRequest)
+{
+    {
+        // Workers take references to originals of duplicate files under the same lock
+        std::lock_guard<std::mutex> lock(_sharingMutex);
+        if (--textureRequest.numReferences > 0) {
+            return;
+        }
+
+        const auto candidates = _requestsByContentHash.equal_range(textureRequest.contentHash);
+        for (auto hashIt = candidates.first; hashIt != candidates.second; ++hashIt)
+        {
+            if (hashIt->second == &textureRequest)
+            {
+                _requestsByContentHash.erase(hashIt);
+                break;
+            }
+        }
+    }
+
+    // Forget the texture, so that a new request loads the image again
+    _requestsByTexture.erase(textureRequest.textureID);
+    for (auto pathIt = _requestsByPath.begin(); pathIt != _requestsByPath.end();)
+    {
+        if (pathIt->second == &textureRequest) {
+            pathIt = _requestsByPath.erase(pathIt);
+        }
+        else {
+            ++pathIt;
+        }
+    }
+
+    deleteIfReleased(textureRequest);
+    // A duplicate holds a reference to its original from the moment it has been redirected
+    if (textureRequest.isUploaded && textureRequest.original != nullptr) {
+        releaseRequest(*textureRequest.original);
+    }
+}
+
+void TextureLoader::uploadDecoded()
+{
+    std::vector<TextureRequest*> decodedRequests;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        decodedRequests.swap(_decodedRequests);
+        _numPending -= static_cast<int>(decodedRequests.size());
+    }
+
+    for (auto textureRequest : decodedRequests) {
+        uploadRequest(*textureRequest);
+    }
+}
+
+void TextureLoader::finish()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _requestDecoded.wait(lock, [this] { return _numPending == 0 || !_decodedRequests.empty(); });
+            if (_numPending == 0) {
+                break;
+            }
+        }
+
+        // Upload whatever is decoded while the rest is still being decoded
+        uploadDecoded();
+    }
+
+    // Textures already being streamed are completed right away
+    if (!_streamingRequests.empty())
+    {
+        for (auto textureRequest : _streamingRequests)
+        {
+            size_t uploadedBytes = 0;
+            streamRequest(*textureRequest, SIZE_MAX, true, uploadedBytes);
+        }
+        _streamingRequests.clear();
+        _stagingRing->fence();
+        PixelUnpackRing::unbind();
+    }
+
+    reportTimings();
+    _isReported = true;
+}
+
+void TextureLoader::streamDecoded(size_t byteBudget)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _streamingRequests.insert(_streamingRequests.end(), _decodedRequests.begin(), _decodedRequests.end());
+        _numPending -= static_cast<int>(_decodedRequests.size());
+        _decodedRequests.clear();
+    }
+
+    if (_streamingRequests.empty()) {
+        return;
+    }
+    if (!_stagingRing) {
+        _stagingRing.reset(new PixelUnpackRing(STAGING_RING_SIZE));
+    }
+
+    // Requests are completed in order, the budget left over by one goes to the next
+    size_t uploadedBytes = 0;
+    size_t numCompleted = 0;
+    while (numCompleted < _streamingRequests.size() && uploadedBytes < byteBudget
+        && streamRequest(*_streamingRequests[numCompleted], byteBudget, false, uploadedBytes))
+    {
+        numCompleted++;
+    }
+    _streamingRequests.erase(_streamingRequests.begin(), _streamingRequests.begin() + numCompleted);
+
+    _stagingRing->fence();
+    PixelUnpackRing::unbind();
+
+    if (!_isReported && getNumPending() == 0)
+    {
+        reportTimings();
+        _isReported = true;
+    }
+}
+
+int TextureLoader::getNumPending() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _numPending + static_cast<int>(_streamingRequests.size());
+}
+
+TextureLoader::TextureRequest* TextureLoader::findOriginal(TextureRequest& textureRequest, const MappedFile& file)
+{
+    // Identical files under different names share a texture, the hash only finds candidates
+    const auto contentHash = hashContents(file);
+    std::lock_guard<std::mutex> lock(_sharingMutex);
+    textureRequest.contentHash = contentHash;
+    const auto candidates = _requestsByContentHash.equal_range(contentHash);
+    for (auto it = candidates.first; it != candidates.second; ++it)
+    {
+        // Released textures may still be deleted, even if their file matches
+        auto& candidate = *it->second;
+        if (candidate.numReferences > 0 && hasContents(candidate.image.path, file))
+        {
+            candidate.numReferences++;
+            return &candidate;
+        }
+    }
+
+    if (textureRequest.numReferences > 0) {
+        _requestsByContentHash.emplace(contentHash, &textureRequest);
+    }
+    return nullptr;
+}
+
+void TextureLoader::redirectDuplicate(TextureRequest& textureRequest)
+{
+    // The duplicate's own texture name stays valid (and empty) until released, getTexture gives the original
+    _numContentHits++;
+    textureRequest.original->numHits++;
+    textureRequest.isUploaded = true;
+    if (textureRequest.numReferences == 0)
+    {
+        deleteIfReleased(textureRequest);
+        releaseRequest(*textureRequest.original);
+    }
+}
+
+GLuint TextureLoader::addReference(TextureRequest& textureRequest)
+{
+    textureRequest.numReferences++;
+    textureRequest.numHits++;
+    return textureRequest.textureID;
+}
+
+void TextureLoader::deleteIfReleased(TextureRequest& textureRequest)
+{
+    // A texture still loading is deleted once its upload is done
+    if (textureRequest.numReferences == 0 && textureRequest.isUploaded && textureRequest.textureID != 0)
+    {
+        glDeleteTextures(1, &textureRequest.textureID);
+        textureRequest.textureID = 0;
+    }
+}
+
+void TextureLoader::uploadRequest(TextureRequest& textureRequest)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    if (textureRequest.original != nullptr) {
+        redirectDuplicate(textureRequest);
+    }
+    else if (textureRequest.isCooked)
+    {
+        uploadCookedTexture(textureRequest.textureID, textureRequest.cookedTexture, textureRequest.image.quality);
+        textureRequest.cookedTexture.close();
+    }
+    else
+    {
+        uploadDecodedImage(textureRequest.textureID, textureRequest.image);
+        freeDecodedImage(textureRequest.image);
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    textureRequest.uploadMilliseconds = elapsed.count();
+    textureRequest.isUploaded = true;
+    deleteIfReleased(textureRequest);
+}
+
+bool TextureLoader::streamRequest(TextureRequest& textureRequest, size_t byteBudget, bool waitForSpace, size_t& uploadedBytes)
+{
+    if (textureRequest.original != nullptr)
+    {
+        redirectDuplicate(textureRequest);
+        return true;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    if (textureRequest.isCooked) {
+        streamCookedLevels(textureRequest, byteBudget, waitForSpace, uploadedBytes);
+    }
+    else if (textureRequest.image.pixels == nullptr)
+    {
+        // Nothing to stream, the upload just reports the failure
+        PixelUnpackRing::unbind();
+        uploadDecodedImage(textureRequest.textureID, textureRequest.image);
+        textureRequest.isUploaded = true;
+    }
+    else {
+        streamImageRows(textureRequest, byteBudget, waitForSpace, uploadedBytes);
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    textureRequest.uploadMilliseconds += elapsed.count();
+    deleteIfReleased(textureRequest);
+    return textureRequest.isUploaded;
+}
+
+void TextureLoader::streamImageRows(TextureRequest& textureRequest, size_t byteBudget, bool waitForSpace, size_t& uploadedBytes)
+{
+    auto& image = textureRequest.image;
+    const auto& format = image.format;
+    const auto rowBytes = static_cast<size_t>(image.width) * getBytesPerPixel(format);
+
+    glBindTexture(GL_TEXTURE_2D, textureRequest.textureID);
+    if (!textureRequest.isAllocated)
+    {
+        // Allocate storage only, rows are filled in from the staging ring
+        PixelUnpackRing::unbind();
+        glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, image.width, image.height, 0, format.format, format.type, nullptr);
+        setDefaultTextureParameters(format.numComponents);
+        textureRequest.isAllocated = true;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    while (textureRequest.numUploadedRows < image.height)
+    {
+        // Always upload at least one row per call, so that a small budget still makes progress
+        const auto budgetRows = uploadedBytes < byteBudget ? (byteBudget - uploadedBytes) / rowBytes : 0;
+        if (budgetRows == 0 && uploadedBytes > 0) {
+            break;
+        }
+
+        const auto numRows = static_cast<int>(std::min({ static_cast<size_t>(image.height - textureRequest.numUploadedRows),
+            std::max<size_t>(budgetRows, 1), std::max<size_t>(_stagingRing->getSize() / rowBytes, 1) }));
+        const auto size = numRows * rowBytes;
+        const auto source = image.pixels + textureRequest.numUploadedRows * rowBytes;
+        const auto data = _stagingRing->map(size, waitForSpace);
+        if (data != nullptr)
+        {
+            memcpy(data, source, size);
+            const auto offset = _stagingRing->unmap();
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, textureRequest.numUploadedRows, image.width, numRows, format.format, format.type, reinterpret_cast<const void*>(offset));
+        }
+        else if (size > _stagingRing->getSize())
+        {
+            // Row too large for the ring, upload it from client memory
+            PixelUnpackRing::unbind();
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, textureRequest.numUploadedRows, image.width, numRows, format.format, format.type, source);
+        }
+        else {
+            // Ring is full of uploads in flight, continue next frame
+            break;
+        }
+
+        textureRequest.numUploadedRows += numRows;
+        uploadedBytes += size;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (textureRequest.numUploadedRows == image.height)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        freeDecodedImage(image);
+        textureRequest.isUploaded = true;
+    }
+}
+
+void TextureLoader::streamCookedLevels(TextureRequest& textureRequest, size_t byteBudget, bool waitForSpace, size_t& uploadedBytes)
+{
+    auto& cookedTexture = textureRequest.cookedTexture;
+    const auto& format = cookedTexture.getFormat();
+    const auto firstLevel = getFirstCookedMipLevel(cookedTexture, textureRequest.image.quality);
+    const auto numMipLevels = cookedTexture.getNumMipLevels() - firstLevel;
+
+    glBindTexture(GL_TEXTURE_2D, textureRequest.textureID);
+    if (!textureRequest.isAllocated)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numMipLevels - 1);
+        setDefaultTextureParameters(format.numComponents);
+        textureRequest.isAllocated = true;
+    }
+
+    while (textureRequest.numUploadedLevels < numMipLevels)
+    {
+        const auto level = textureRequest.numUploadedLevels;
+        const auto mipLevel = cookedTexture.getMipLevel(firstLevel + level);
+        // Always upload at least one level per call, so that a small budget still makes progress
+        if (uploadedBytes > 0 && uploadedBytes + mipLevel.size > byteBudget) {
+            break;
+        }
+
+        if (!uploadMipLevel(*_stagingRing, format, level, mipLevel, waitForSpace)) {
+            // Ring is full of uploads in flight, continue next frame
+            break;
+        }
+
+        textureRequest.numUploadedLevels++;
+        uploadedBytes += mipLevel.size;
+    }
+
+    if (textureRequest.numUploadedLevels == numMipLevels)
+    {
+        cookedTexture.close();
+        textureRequest.isUploaded = true;
+    }
+}
+
+void TextureLoader::reportTimings() const
+{
+    const std::chrono::duration<double, std::milli> wallTime = std::chrono::steady_clock::now() - _firstRequestTime;
+
+    std::cout << "Loaded " << _requests.size() << " textures using " << _threadPool.getNumThreads() << " decoding threads:" << std::endl;
+    auto totalDecodeMilliseconds = 0.0;
+    auto sharedDecodeMilliseconds = 0.0;
+    size_t totalSavedBytes = 0;
+    size_t sharedBytes = 0;
+    for (const auto& textureRequest : _requests)
+    {
+        const auto& image = textureRequest->image;
+        totalDecodeMilliseconds += image.decodeMilliseconds;
+        if (textureRequest->original != nullptr)
+        {
+            std::cout << "  " << std::left << std::setw(28) << image.path << std::right << " same contents as " << textureRequest->original->image.path << std::endl;
+            continue;
+        }
+
+        std::cout << "  " << std::left << std::setw(28) << image.path << std::right
+            << std::setw(5) << image.width << "x" << std::setw(5) << std::left << image.height << std::right
+            << " decode " << std::fixed << std::setprecision(2) << std::setw(8) << image.decodeMilliseconds << " ms"
+            << ", upload " << std::setw(7) << textureRequest->uploadMilliseconds << " ms";
+        if (image.format.internalFormat != 0)
+        {
+            // VRAM saved against the 8-bit format with the same number of components, mip levels included
+            // (cooked textures only know the components they store, so greyscale images cooked to GL_R8 save nothing here)
+            const auto savedBytes = textureRequest->uncompressedBytes - std::min(textureRequest->textureBytes, textureRequest->uncompressedBytes);
+            std::cout << " (" << (textureRequest->isCooked ? "cooked, " : "") << getInternalFormatName(image.format.internalFormat)
+                << ", saved " << std::setw(7) << savedBytes / 1024.0 << " KB)";
+            totalSavedBytes += savedBytes;
+        }
+        if (textureRequest->numHits > 0) {
+            std::cout << " shared by " << textureRequest->numHits + 1 << " requests";
+        }
+        std::cout << std::endl;
+        // Every hit would have decoded and uploaded the image once more
+        sharedDecodeMilliseconds += textureRequest->numHits * image.decodeMilliseconds;
+        sharedBytes += textureRequest->numHits * textureRequest->textureBytes;
+    }
+
+    std::cout << "Sum of decode times " << totalDecodeMilliseconds << " ms, wall time " << wallTime.count()
+        << " ms (" << totalDecodeMilliseconds / std::max(wallTime.count(), 0.001) << "x), minimal and compressed formats saved "
+        << totalSavedBytes / (1024.0 * 1024.0) << " MB of VRAM" << std::endl;
+    const auto numHits = _numPathHits + _numContentHits;
+    std::cout << "Texture sharing: " << _numRequests << " requests, " << _numPathHits << " path hits, " << _numContentHits
+        << " content hits (" << 100.0 * numHits / std::max(_numRequests, 1) << "% hit rate), saved "
+        << sharedBytes / (1024.0 * 1024.0) << " MB of VRAM and " << sharedDecodeMilliseconds << " ms of decoding" << std::defaultfloat << std::endl;
+}
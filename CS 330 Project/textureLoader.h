@@ -0,0 +1,243 @@
+#pragma once
+// STL
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+// Project
+#include "threadPool.h"
+#include "cookedTexture.h"
+#include "pixelUnpackRing.h"
+#include "mappedFile.h"
+
+/**
+ * Resolution textures are loaded at. Below full quality, JPEGs are decoded at reduced size straight
+ * from their DCT coefficients and cooked textures skip their largest mip levels, which cuts decode
+ * time, memory and upload bandwidth alike. Other images are still decoded at full size.
+ */
+enum class TextureQuality
+{
+    Full, // Full resolution
+    Half, // 1/2 of the width and height
+    Quarter, // 1/4 of the width and height
+    Eighth // 1/8 of the width and height
+};
+
+/**
+ * Sets quality of all textures requested from now on. Safe to call while images are being loaded,
+ * every request keeps the quality it was made at (see DecodedImage::quality).
+ */
+void setTextureQuality(TextureQuality quality);
+
+/**
+ * Gets quality textures are requested at.
+ */
+TextureQuality getTextureQuality();
+
+/**
+ * Image decoded to CPU memory, waiting to be uploaded to the GPU.
+ */
+struct DecodedImage
+{
+    std::string path; // Path the image was loaded from
+    unsigned char* pixels = nullptr; // Pixel data in the format below, nullptr if decoding failed
+    int width = 0; // Image width in pixels
+    int height = 0; // Image height in pixels
+    int numComponents = 0; // Number of components per pixel (1-4) in the image file
+    CookedTextureFormat format; // Format the pixels are stored in, 8 bits per component unless converted
+    TextureQuality quality = getTextureQuality(); // Quality to load at, captured when the image is requested
+    double decodeMilliseconds = 0.0; // How long the decoding took
+};
+
+/**
+ * Sets pool that single large JPEGs are decoded on. JPEGs with restart markers have their entropy
+ * coded segments decoded in parallel, and the color conversion of large images is split into bands.
+ * Others are still decoded on the calling thread. Pass nullptr to decode everything serially again.
+ * Decoding threads read the pool unguarded, so set it before any image is decoded.
+ */
+void setDecodeThreadPool(ThreadPool* threadPool);
+
+/**
+ * Gets first mip level of a cooked texture to upload at given quality (the smallest level at most).
+ */
+int getFirstCookedMipLevel(const CookedTexture& cookedTexture, TextureQuality quality);
+
+/**
+ * Decodes image file to memory, at the quality of the image. Safe to call from any thread.
+ *
+ * @return True, if image has been decoded successfully.
+ */
+bool decodeImage(const std::string& path, DecodedImage& image);
+
+/**
+ * Converts decoded pixels (in place) to the smallest format holding them without loss, so that
+ * e.g. greyscale maps saved as RGB take a third of the memory. See chooseMinimalFormat.
+ */
+void convertToMinimalFormat(DecodedImage& image);
+
+/**
+ * Frees pixel data of decoded image.
+ */
+void freeDecodedImage(DecodedImage& image);
+
+/**
+ * Uploads decoded image (in its format) to given texture, generates mipmaps and sets default sampling
+ * parameters (repeat, trilinear). Must be called from the thread owning the GL context.
+ */
+void uploadDecodedImage(GLuint textureID, const DecodedImage& image);
+
+/**
+ * Uploads all mip levels of a cooked texture straight from its mapping (no mipmap generation)
+ * and sets the same sampling parameters as uploadDecodedImage. GL thread only.
+ */
+void uploadCookedTexture(GLuint textureID, const CookedTexture& cookedTexture, TextureQuality quality);
+
+/**
+ * Sets default sampling parameters (repeat, trilinear) of the bound 2D texture, plus a swizzle
+ * making 1 and 2 component textures sample as greyscale. GL thread only.
+ */
+void setDefaultTextureParameters(int numComponents);
+
+/**
+ * Uploads one mip level to the bound 2D texture through the staging ring. Levels larger than
+ * the ring are uploaded straight from memory. GL thread only.
+ *
+ * @param stagingRing   Ring to stage the level data in
+ * @param format        Pixel format of the level data
+ * @param level         Mip level to upload
+ * @param mipLevel      Level data
+ * @param waitForSpace  Wait for the ring to have space, instead of giving up
+ *
+ * @return False, if the ring is full of uploads in flight and nothing has been uploaded.
+ */
+bool uploadMipLevel(PixelUnpackRing& stagingRing, const CookedTextureFormat& format, int level, const TextureMipLevel& mipLevel, bool waitForSpace);
+
+/**
+ * Loads textures with all images decoded in parallel on a thread pool. Texture names
+ * are handed out immediately, decoded pixels are converted to their minimal format on
+ * the pool and uploaded on the GL thread. If a cooked container exists for an image
+ * (see getCookedTexturePath), it is mapped and uploaded as it is instead of decoding
+ * the image.
+ *
+ * Textures are shared and reference counted. Requesting a path again returns the texture of
+ * the first request. Another file with the same contents (found on the pool by a hash of the
+ * file, confirmed byte by byte) isn't decoded or uploaded, its texture is redirected to the
+ * first one instead (see getTexture), so every unique image is decoded and uploaded once.
+ *
+ * Decoded textures are either uploaded all at once (uploadDecoded / finish), or streamed
+ * through a pixel unpack buffer ring over several frames under a per-frame byte budget
+ * (streamDecoded), so that loading textures while rendering doesn't cause frame hitches.
+ */
+class TextureLoader
+{
+public:
+    explicit TextureLoader(ThreadPool& threadPool);
+
+    /**
+     * Waits for decoding still in progress, so that no worker touches a destroyed loader.
+     */
+    ~TextureLoader();
+
+    /**
+     * Requests texture to be loaded and takes a reference to it. Decoding starts right away on
+     * the thread pool, unless the path or the file contents have been requested before.
+     *
+     * @param path  Path to the image file
+     *
+     * @return OpenGL texture ID, which gets its data once the image is uploaded.
+     */
+    GLuint request(const std::string& path);
+
+    /**
+     * Gets texture to bind for a texture ID handed out by request. That is the ID itself, unless
+     * the file turned out to have the contents of another one, whose texture is then returned.
+     */
+    GLuint getTexture(GLuint textureID) const;
+
+    /**
+     * Drops reference taken by request. The texture is deleted with its last reference (after
+     * its upload, if it is still loading), requesting its image again then loads it anew. GL thread only.
+     */
+    void release(GLuint textureID);
+
+    /**
+     * Uploads all images decoded so far, never waits for decoding (GL thread only).
+     */
+    void uploadDecoded();
+
+    /**
+     * Streams decoded images to their textures through the staging ring, uploading at most
+     * byteBudget bytes per call (but always making progress). Large images are uploaded in
+     * bands of rows, cooked textures one mip level at a time. Call once per frame (GL thread only).
+     *
+     * @param byteBudget  Maximum number of bytes to upload during this call
+     */
+    void streamDecoded(size_t byteBudget);
+
+    /**
+     * Waits for all requested images, uploads them and reports per-texture timings (GL thread only).
+     */
+    void finish();
+
+    /**
+     * Gets number of requested textures not uploaded yet (including textures being streamed).
+     */
+    int getNumPending() const;
+
+private:
+    struct TextureRequest
+    {
+        GLuint textureID = 0;
+        DecodedImage image;
+        CookedTexture cookedTexture; // Open only if the image has been cooked
+        bool isCooked = false;
+        bool isUploaded = false;
+        bool isAllocated = false; // Flag telling, if streaming has allocated texture storage already
+        int numUploadedRows = 0; // Rows of a decoded image streamed so far
+        int numUploadedLevels = 0; // Mip levels of a cooked texture streamed so far
+        double uploadMilliseconds = 0.0;
+        uint64_t contentHash = 0; // Hash of the image file, if it could be read (guarded by sharing mutex)
+        TextureRequest* original = nullptr; // Texture of an identical file, set on the pool if this one is a duplicate
+        size_t textureBytes = 0; // Size of the texture with all its mip levels
+        size_t uncompressedBytes = 0; // Size the texture would have at 8 bits per component, mip levels included
+        std::atomic<int> numReferences{ 1 }; // Requests (and redirected duplicates) of the texture not released yet
+        int numHits = 0; // Requests served by this texture without loading anything
+    };
+
+    ThreadPool& _threadPool; // Pool the images are decoded on
+    std::vector<std::unique_ptr<TextureRequest>> _requests; // All loaded textures, in order of request
+    std::unordered_map<std::string, TextureRequest*> _requestsByPath; // Texture of every requested path
+    std::unordered_multimap<uint64_t, TextureRequest*> _requestsByContentHash; // Textures by hash of their file (guarded by sharing mutex)
+    std::unordered_map<GLuint, TextureRequest*> _requestsByTexture; // Texture of every texture ID handed out
+    int _numRequests = 0; // Number of request calls
+    int _numPathHits = 0; // Requests of a path requested before
+    int _numContentHits = 0; // Requests of a new path with the contents of a file requested before
+    std::vector<TextureRequest*> _decodedRequests; // Decoded requests waiting for upload
+    std::vector<TextureRequest*> _streamingRequests; // Requests being streamed, in order (GL thread only)
+    std::unique_ptr<PixelUnpackRing> _stagingRing; // Created by the first streaming call
+    int _numPending = 0; // Number of requests not uploaded yet
+    bool _isReported = false; // Flag telling, if timings have been reported already
+    mutable std::mutex _mutex; // Guards decoded requests
+    std::mutex _sharingMutex; // Guards content hashes and references taken by the pool
+    std::condition_variable _requestDecoded; // Signalled whenever a request gets decoded
+    std::chrono::steady_clock::time_point _firstRequestTime; // Used to report total load time
+
+    TextureRequest* findOriginal(TextureRequest& textureRequest, const MappedFile& file);
+    void redirectDuplicate(TextureRequest& textureRequest);
+    void releaseRequest(TextureRequest& textureRequest);
+    GLuint addReference(TextureRequest& textureRequest);
+    void deleteIfReleased(TextureRequest& textureRequest);
+    void uploadRequest(TextureRequest& textureRequest);
+    bool streamRequest(TextureRequest& textureRequest, size_t byteBudget, bool waitForSpace, size_t& uploadedBytes);
+    void streamImageRows(TextureRequest& textureRequest, size_t byteBudget, bool waitForSpace, size_t& uploadedBytes);
+    void streamCookedLevels(TextureRequest& textureRequest, size_t byteBudget, bool waitForSpace, size_t& uploadedBytes);
+    void reportTimings() const;
+};
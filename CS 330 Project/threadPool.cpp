@@ -0,0 +1,125 @@
+// STL
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+// Project
+#include "threadPool.h"
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < numThreads; i++) {
+        _workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _taskAvailable.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push(std::move(task));
+    }
+    _taskAvailable.notify_one();
+}
+
+void ThreadPool::waitForAll()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _allTasksDone.wait(lock, [this] { return _tasks.empty() && _numRunningTasks == 0; });
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& body)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    // Shared with the helper tasks, which may start only after this call has returned
+    struct ParallelForState
+    {
+        std::function<void(int)> body;
+        std::atomic<int> nextIndex{ 0 };
+        std::atomic<int> numDone{ 0 };
+        int count = 0;
+        std::mutex mutex;
+        std::condition_variable allDone;
+    };
+
+    auto state = std::make_shared<ParallelForState>();
+    state->body = body;
+    state->count = count;
+
+    const auto runIterations = [](ParallelForState& s)
+    {
+        for (auto i = s.nextIndex++; i < s.count; i = s.nextIndex++)
+        {
+            s.body(i);
+            if (++s.numDone == s.count)
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.allDone.notify_all();
+            }
+        }
+    };
+
+    const auto numHelpers = std::min(static_cast<int>(_workers.size()), count - 1);
+    for (auto i = 0; i < numHelpers; i++) {
+        enqueue([state, runIterations] { runIterations(*state); });
+    }
+
+    runIterations(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->allDone.wait(lock, [&state] { return state->numDone == state->count; });
+}
+
+unsigned int ThreadPool::getNumThreads() const
+{
+    return static_cast<unsigned int>(_workers.size());
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _taskAvailable.wait(lock, [this] { return _isStopping || !_tasks.empty(); });
+            if (_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop();
+            _numRunningTasks++;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _numRunningTasks--;
+            if (_tasks.empty() && _numRunningTasks == 0) {
+                _allTasksDone.notify_all();
+            }
+        }
+    }
+}
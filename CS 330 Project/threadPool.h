@@ -0,0 +1,63 @@
+#pragma once
+// STL
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * Fixed-size pool of worker threads executing queued tasks.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * Creates the pool and starts its worker threads.
+     *
+     * @param numThreads  Number of worker threads (0 means one per hardware thread)
+     */
+    explicit ThreadPool(unsigned int numThreads = 0);
+
+    /**
+     * Finishes all queued tasks and joins the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queues task for execution on one of the worker threads.
+     */
+    void enqueue(std::function<void()> task);
+
+    /**
+     * Blocks until all queued tasks have been executed.
+     */
+    void waitForAll();
+
+    /**
+     * Runs body(i) for every i in [0, count) spread across the workers and blocks until
+     * all iterations are done. Calling thread takes iterations as well, so it is safe
+     * to call this from inside a task.
+     */
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+    /**
+     * Gets number of worker threads.
+     */
+    unsigned int getNumThreads() const;
+
+private:
+    std::vector<std::thread> _workers; // Worker threads
+    std::queue<std::function<void()>> _tasks; // Tasks waiting for execution
+    std::mutex _mutex; // Guards task queue and counters below
+    std::condition_variable _taskAvailable; // Signalled when a task is queued or pool is stopping
+    std::condition_variable _allTasksDone; // Signalled when last running task finishes
+    int _numRunningTasks = 0; // Number of tasks being executed right now
+    bool _isStopping = false; // Flag telling workers to quit once the queue is empty
+
+    void workerLoop();
+};
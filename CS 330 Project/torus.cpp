@@ -0,0 +1,74 @@
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "torus.h"
+#include "sineCosineTable.h"
+
+namespace static_meshes_3D {
+
+	Torus::Torus(float majorRadius, float minorRadius, int numMajorSegments, int numMinorSegments, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat, MeshBufferArena* bufferArena)
+		: IndexedMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat, bufferArena)
+		, _majorRadius(majorRadius)
+		, _minorRadius(minorRadius)
+		, _numMajorSegments(numMajorSegments)
+		, _numMinorSegments(numMinorSegments)
+	{
+		initializeData();
+	}
+
+	float Torus::getMajorRadius() const
+	{
+		return _majorRadius;
+	}
+
+	float Torus::getMinorRadius() const
+	{
+		return _minorRadius;
+	}
+
+	int Torus::getMajorSegments() const
+	{
+		return _numMajorSegments;
+	}
+
+	int Torus::getMinorSegments() const
+	{
+		return _numMinorSegments;
+	}
+
+	void Torus::initializeData()
+	{
+		const auto outerRadius = _majorRadius + _minorRadius;
+		const auto numTriangles = IndexWriter::getNumGridTriangles(_numMajorSegments, _numMinorSegments);
+		generate((_numMajorSegments + 1) * (_numMinorSegments + 1), numTriangles * 3,
+			glm::vec3(-outerRadius, -_minorRadius, -outerRadius), glm::vec3(outerRadius, _minorRadius, outerRadius));
+	}
+
+	void Torus::writeVertices(VertexWriter& vertices) const
+	{
+		const auto major = computeSineCosineTable(_numMajorSegments + 1, 2.0f * glm::pi<float>() / float(_numMajorSegments));
+		const auto minor = computeSineCosineTable(_numMinorSegments + 1, 2.0f * glm::pi<float>() / float(_numMinorSegments));
+
+		// Rings around Y, one per tube segment, starting at the outer equator
+		for (auto ring = 0; ring <= _numMinorSegments; ring++)
+		{
+			const auto v = float(ring) / float(_numMinorSegments);
+			for (auto segment = 0; segment <= _numMajorSegments; segment++)
+			{
+				const auto direction = glm::vec3(major.cosines[segment], 0.0f, -major.sines[segment]);
+				const auto normal = direction * minor.cosines[ring] + glm::vec3(0.0f, minor.sines[ring], 0.0f);
+				vertices.addPosition(direction * _majorRadius + normal * _minorRadius);
+				vertices.addTextureCoordinate(glm::vec2(float(segment) / float(_numMajorSegments), v));
+				vertices.addNormal(normal);
+			}
+		}
+	}
+
+	void Torus::writeIndices(IndexWriter& indices) const
+	{
+		indices.addGrid(0, _numMajorSegments, _numMinorSegments);
+	}
+
+} // namespace static_meshes_3D
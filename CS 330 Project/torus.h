@@ -0,0 +1,49 @@
+#pragma once
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Torus static mesh centered at the origin, lying in the XZ plane. Texture wraps around once
+	* along the ring (U) and once around the tube (V).
+	*/
+	class Torus : public IndexedMesh3D
+	{
+	public:
+		Torus(float majorRadius, float minorRadius, int numMajorSegments, int numMinorSegments,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
+
+		/**
+		 * Gets distance of the tube center from the torus center.
+		 */
+		float getMajorRadius() const;
+
+		/**
+		 * Gets radius of the tube.
+		 */
+		float getMinorRadius() const;
+
+		/**
+		 * Gets number of segments along the ring.
+		 */
+		int getMajorSegments() const;
+
+		/**
+		 * Gets number of segments around the tube.
+		 */
+		int getMinorSegments() const;
+
+	private:
+		float _majorRadius; // Distance of the tube center from the torus center
+		float _minorRadius; // Radius of the tube
+		int _numMajorSegments; // Number of segments along the ring
+		int _numMinorSegments; // Number of segments around the tube
+
+		void initializeData() override;
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
+	};
+
+} // namespace static_meshes_3D
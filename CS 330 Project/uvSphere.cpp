@@ -0,0 +1,66 @@
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "uvSphere.h"
+#include "sineCosineTable.h"
+
+namespace static_meshes_3D {
+
+	UVSphere::UVSphere(float radius, int numSlices, int numStacks, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout, VertexFormat vertexFormat, MeshBufferArena* bufferArena)
+		: IndexedMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout, vertexFormat, bufferArena)
+		, _radius(radius)
+		, _numSlices(numSlices)
+		, _numStacks(numStacks)
+	{
+		initializeData();
+	}
+
+	float UVSphere::getRadius() const
+	{
+		return _radius;
+	}
+
+	int UVSphere::getSlices() const
+	{
+		return _numSlices;
+	}
+
+	int UVSphere::getStacks() const
+	{
+		return _numStacks;
+	}
+
+	void UVSphere::initializeData()
+	{
+		// Every ring repeats its first vertex for the texture seam, pole rings too
+		const auto numTriangles = IndexWriter::getNumGridTriangles(_numSlices, _numStacks, true, true);
+		generate((_numSlices + 1) * (_numStacks + 1), numTriangles * 3, glm::vec3(-_radius), glm::vec3(_radius));
+	}
+
+	void UVSphere::writeVertices(VertexWriter& vertices) const
+	{
+		const auto slices = computeSineCosineTable(_numSlices + 1, 2.0f * glm::pi<float>() / float(_numSlices));
+		const auto latitudes = computeSineCosineTable(_numStacks + 1, glm::pi<float>() / float(_numStacks), -glm::half_pi<float>());
+
+		// Rings from the south to the north pole
+		for (auto stack = 0; stack <= _numStacks; stack++)
+		{
+			const auto v = float(stack) / float(_numStacks);
+			for (auto slice = 0; slice <= _numSlices; slice++)
+			{
+				const auto normal = glm::vec3(latitudes.cosines[stack] * slices.cosines[slice], latitudes.sines[stack], -latitudes.cosines[stack] * slices.sines[slice]);
+				vertices.addPosition(normal * _radius);
+				vertices.addTextureCoordinate(glm::vec2(float(slice) / float(_numSlices), v));
+				vertices.addNormal(normal);
+			}
+		}
+	}
+
+	void UVSphere::writeIndices(IndexWriter& indices) const
+	{
+		indices.addGrid(0, _numSlices, _numStacks, true, true);
+	}
+
+} // namespace static_meshes_3D
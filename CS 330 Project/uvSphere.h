@@ -0,0 +1,43 @@
+#pragma once
+#include "indexedMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Sphere static mesh centered at the origin, made of slices (around Y) and stacks (from pole to pole).
+	* Texture wraps around once (U) and spans from the south to the north pole (V).
+	*/
+	class UVSphere : public IndexedMesh3D
+	{
+	public:
+		UVSphere(float radius, int numSlices, int numStacks,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar, VertexFormat vertexFormat = VertexFormat::Float,
+			MeshBufferArena* bufferArena = nullptr);
+
+		/**
+		 * Gets sphere radius.
+		 */
+		float getRadius() const;
+
+		/**
+		 * Gets number of sphere slices.
+		 */
+		int getSlices() const;
+
+		/**
+		 * Gets number of sphere stacks.
+		 */
+		int getStacks() const;
+
+	private:
+		float _radius; // Sphere radius
+		int _numSlices; // Number of slices around Y
+		int _numStacks; // Number of stacks from pole to pole
+
+		void initializeData() override;
+		void writeVertices(VertexWriter& vertices) const override;
+		void writeIndices(IndexWriter& indices) const override;
+	};
+
+} // namespace static_meshes_3D
@@ -3,7 +3,6 @@
 
 // STL
 #include <iostream>
-#include <cstring>
 
 // Project
 #include "vertexBufferObject.h"
@@ -17,9 +16,11 @@ void VertexBufferObject::createVBO(size_t reserveSizeBytes)
     }
 
     glGenBuffers(1, &_bufferID);
-    _rawData.reserve(reserveSizeBytes > 0 ? reserveSizeBytes : 1024);
+    if (reserveSizeBytes > 0) {
+        _staging = StagingArena::acquire(reserveSizeBytes);
+    }
 
-    std::cout << "Created vertex buffer object with ID " << _bufferID << " and initial reserved size " << _rawData.capacity() << " bytes" << std::endl;
+    std::cout << "Created vertex buffer object with ID " << _bufferID << " and initial reserved size " << reserveSizeBytes << " bytes" << std::endl;
     _isBufferCreated = true;
 }
 
@@ -35,33 +36,70 @@ void VertexBufferObject::bindVBO(GLenum bufferType)
     glBindBuffer(_bufferType, _bufferID);
 }
 
-void VertexBufferObject::addRawData(const void* ptrData, size_t dataSize, int repeat)
+bool VertexBufferObject::mapDataForWriting(GLenum bufferType, size_t sizeBytes, GLenum usageHint)
 {
-    const auto bytesToAdd = dataSize * repeat;
-    const auto requiredCapacity = _bytesAdded + bytesToAdd;
-    if (requiredCapacity > _rawData.capacity())
+    if (!_isBufferCreated || _bytesAdded > 0)
     {
-        auto newCapacity = _rawData.capacity() * 2;
-        while (newCapacity < requiredCapacity) {
-            newCapacity *= 2;
+        std::cerr << "Only created buffers without any data added can be mapped for writing!" << std::endl;
+        return false;
+    }
+    if (sizeBytes == 0) {
+        return false;
+    }
+
+    bindVBO(bufferType);
+    glBufferData(_bufferType, static_cast<GLsizeiptr>(sizeBytes), nullptr, usageHint);
+    _mappedData = static_cast<unsigned char*>(glMapBufferRange(_bufferType, 0, static_cast<GLsizeiptr>(sizeBytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (_mappedData == nullptr)
+    {
+        // Storage stays allocated, the staged data simply replaces it on upload
+        if (!_staging) {
+            _staging = StagingArena::acquire(sizeBytes);
         }
+        return false;
+    }
 
-        std::vector<unsigned char> newRawData;
-        newRawData.reserve(newCapacity);
-        memcpy(newRawData.data(), _rawData.data(), _bytesAdded);
-        _rawData = std::move(newRawData);
+    _mappedSize = sizeBytes;
+    return true;
+}
+
+void VertexBufferObject::addRawData(const void* ptrData, size_t dataSize, int repeat)
+{
+    const auto target = addUninitializedData(dataSize * repeat);
+    if (target != nullptr) {
+        fillRepeated(target, ptrData, dataSize, repeat);
     }
+}
 
-    for (int i = 0; i < repeat; i++)
+unsigned char* VertexBufferObject::addUninitializedData(size_t dataSizeBytes)
+{
+    if (_mappedData != nullptr)
     {
-        memcpy(_rawData.data() + _bytesAdded, ptrData, dataSize);
-        _bytesAdded += dataSize;
+        if (_bytesAdded + dataSizeBytes > _mappedSize)
+        {
+            std::cerr << "Data added to vertex buffer object with ID " << _bufferID << " exceed its mapped size of " << _mappedSize << " bytes!" << std::endl;
+            return nullptr;
+        }
+
+        const auto result = _mappedData + _bytesAdded;
+        _bytesAdded += dataSizeBytes;
+        return result;
+    }
+
+    if (!_staging) {
+        _staging = StagingArena::acquire(dataSizeBytes);
     }
+    _bytesAdded += dataSizeBytes;
+    return _staging->allocate(dataSizeBytes);
 }
 
 void* VertexBufferObject::getRawDataPointer()
 {
-    return _rawData.data();
+    if (_mappedData != nullptr) {
+        return _mappedData;
+    }
+
+    return _staging ? _staging->getData() : nullptr;
 }
 
 void VertexBufferObject::uploadDataToGPU(GLenum usageHint)
@@ -72,7 +110,22 @@ void VertexBufferObject::uploadDataToGPU(GLenum usageHint)
         return;
     }
 
-    glBufferData(_bufferType, _bytesAdded, _rawData.data(), usageHint);
+    if (_mappedData != nullptr)
+    {
+        // Data is in the buffer already, unmapping only fails if the GL lost it (e.g. on display mode change)
+        glBindBuffer(_bufferType, _bufferID);
+        if (glUnmapBuffer(_bufferType) == GL_FALSE) {
+            std::cerr << "Data of vertex buffer object with ID " << _bufferID << " got corrupted while mapped!" << std::endl;
+        }
+        _mappedData = nullptr;
+        _mappedSize = 0;
+    }
+    else
+    {
+        glBufferData(_bufferType, _bytesAdded, _staging ? _staging->getData() : nullptr, usageHint);
+        StagingArena::recycle(std::move(_staging));
+    }
+
     _isDataUploaded = true;
     _uploadedDataSize = _bytesAdded;
     _bytesAdded = 0;
@@ -118,6 +171,15 @@ void VertexBufferObject::deleteVBO()
     }
 
     std::cout << "Deleting vertex buffer object with ID " << _bufferID << "..." << std::endl;
+    if (_mappedData != nullptr)
+    {
+        glBindBuffer(_bufferType, _bufferID);
+        glUnmapBuffer(_bufferType);
+        _mappedData = nullptr;
+        _mappedSize = 0;
+    }
+    StagingArena::recycle(std::move(_staging));
+    _bytesAdded = 0;
     glDeleteBuffers(1, &_bufferID);
     _isDataUploaded = false;
     _isBufferCreated = false;
@@ -1,11 +1,16 @@
 #pragma once
 //#include <GL/glew.h>
 // STL
-#include <vector>
+#include <memory>
 #include <glad/glad.h>
 
+// Project
+#include "stagingArena.h"
+
 /**
- * Wraps OpenGL's vertex buffer object to a convenient higher level class.
+ * Wraps OpenGL's vertex buffer object to a convenient higher level class. Data is assembled either
+ * in a pooled staging arena, which goes back to the pool after the upload, or, if the final size
+ * is known up front, right in the mapped GPU buffer (see mapDataForWriting).
  */
 class VertexBufferObject
 {
@@ -17,6 +22,19 @@ public:
      */
     void createVBO(size_t reserveSizeBytes = 0);
 
+    /**
+     * Allocates GPU storage of given final size and maps it, so that the data added afterwards is
+     * written straight into the buffer, without staging copy. Must be called before any data is added.
+     * If mapping fails, data is staged in memory as usual. Either way, uploadDataToGPU finishes it.
+     *
+     * @param bufferType  Type of the buffer, it gets bound (GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER...)
+     * @param sizeBytes   Exact number of bytes that will be added
+     * @param usageHint   Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+     *
+     * @return True, if the buffer is mapped, false if data is staged in memory instead.
+     */
+    bool mapDataForWriting(GLenum bufferType, size_t sizeBytes, GLenum usageHint);
+
     /**
      * Binds this vertex buffer object (makes current).
      *
@@ -29,7 +47,7 @@ public:
      *
      * @param ptrData   Pointer to the raw data (arbitrary type)
      * @param dataSize  Size of the added data (in bytes)
-     * @param repeat    How many times to repeat same data in the buffer (default is 1)
+     * @param repeat    How many times to repeat same data in the buffer (default is 1), filled in bulk
      */
     void addRawData(const void* ptrData, size_t dataSizeBytes, int repeat = 1);
 
@@ -46,14 +64,32 @@ public:
     }
 
     /**
-     * Gets pointer to the raw data from in-memory buffer (only before uploading them).
+     * Appends uninitialized bytes to the in-memory buffer, to be written in place (e.g. interleaved vertex attributes).
+     *
+     * @param dataSizeBytes  Number of bytes to append
+     *
+     * @return Pointer to the appended bytes, valid until more data is added (nullptr, if they don't fit the mapped buffer).
+     */
+    unsigned char* addUninitializedData(size_t dataSizeBytes);
+
+    /**
+     * Appends given number of uninitialized elements of type T, to be written through the returned span.
+     */
+    template<typename T>
+    StagingSpan<T> addSpan(size_t count)
+    {
+        return StagingSpan<T>(addUninitializedData(count * sizeof(T)), count);
+    }
+
+    /**
+     * Gets pointer to the raw data from in-memory buffer or mapped buffer (only before uploading them).
      */
     void* getRawDataPointer();
 
     /** 
-     * Uploads gathered data to the GPU memory. Now the VBO is ready to be used.
+     * Uploads gathered data to the GPU memory (or unmaps the buffer they were written to). Now the VBO is ready to be used.
      *
-     * @param usageHint  Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+     * @param usageHint  Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW), ignored for mapped data
      */
     void uploadDataToGPU(GLenum usageHint);
 
@@ -101,7 +137,9 @@ private:
     GLuint _bufferID = 0; // OpenGL assigned buffer ID
     int _bufferType; // Buffer type (GL_ARRAY_BUFFER, GL_ELEMENT_BUFFER...)
 
-    std::vector<unsigned char> _rawData; // In-memory raw data buffer, used to gather the data for VBO.
+    std::unique_ptr<StagingArena> _staging; // In-memory raw data buffer, used to gather the data for VBO (pooled, only while gathering)
+    unsigned char* _mappedData = nullptr; // Mapped buffer the data is gathered in instead, if mapped for writing
+    size_t _mappedSize = 0; // Size of the mapped buffer
     size_t _bytesAdded = 0; // Number of bytes added to the buffer so far
     size_t _uploadedDataSize; // Holds buffer data size after uploading to GPU
 
@@ -0,0 +1,86 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+// Project
+#include "vertexFetchBenchmark.h"
+#include "cylinder.h"
+
+namespace {
+
+const int NUM_SLICES = 16000; // About 64000 vertices, as many as 16-bit indices allow
+const int NUM_INSTANCES = 32; // Instances per draw, each one fetches all vertices again
+const int NUM_DRAWS = 16; // Draws per measurement
+const int NUM_ROUNDS = 5; // Measurements per layout, the fastest one counts
+
+/**
+ * Measures GPU time of drawing the cylinder NUM_DRAWS times.
+ */
+double measureDraws(const static_meshes_3D::Cylinder& cylinder, GLuint programID, GLuint query)
+{
+    cylinder.setQuantizationUniforms(programID);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    for (auto i = 0; i < NUM_DRAWS; i++) {
+        cylinder.renderInstanced(NUM_INSTANCES);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    return nanoseconds / 1.0e6;
+}
+
+} // namespace
+
+void benchmarkVertexFetch(GLuint programID)
+{
+    using static_meshes_3D::Cylinder;
+    using static_meshes_3D::VertexLayout;
+    using static_meshes_3D::VertexFormat;
+
+    const Cylinder planarCylinder(1.0f, NUM_SLICES, 1.0f, true, true, true, VertexLayout::Planar);
+    const Cylinder interleavedCylinder(1.0f, NUM_SLICES, 1.0f, true, true, true, VertexLayout::Interleaved);
+    const Cylinder quantizedCylinder(1.0f, NUM_SLICES, 1.0f, true, true, true, VertexLayout::Interleaved, VertexFormat::Quantized);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, 1, 1);
+    glUseProgram(programID);
+
+    GLuint query;
+    glGenQueries(1, &query);
+
+    // Warm up all meshes first, then alternate them, so that clocks and caches treat them alike
+    measureDraws(planarCylinder, programID, query);
+    measureDraws(interleavedCylinder, programID, query);
+    measureDraws(quantizedCylinder, programID, query);
+    auto planarMilliseconds = 1.0e9;
+    auto interleavedMilliseconds = 1.0e9;
+    auto quantizedMilliseconds = 1.0e9;
+    for (auto round = 0; round < NUM_ROUNDS; round++)
+    {
+        planarMilliseconds = std::min(planarMilliseconds, measureDraws(planarCylinder, programID, query));
+        interleavedMilliseconds = std::min(interleavedMilliseconds, measureDraws(interleavedCylinder, programID, query));
+        quantizedMilliseconds = std::min(quantizedMilliseconds, measureDraws(quantizedCylinder, programID, query));
+    }
+
+    glDeleteQueries(1, &query);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    // Every index is one vertex shader invocation, minus what the post-transform cache saves
+    const auto numIndices = static_cast<double>(NUM_SLICES) * 12 * NUM_INSTANCES * NUM_DRAWS;
+    const auto report = [numIndices](const char* name, const Cylinder& cylinder, double milliseconds)
+    {
+        std::cout << "  " << std::left << std::setw(12) << name << std::right << std::setw(3) << cylinder.getVertexByteSize() << " B/vertex"
+            << std::fixed << std::setprecision(3) << std::setw(9) << milliseconds << " ms, "
+            << std::setprecision(1) << numIndices / (milliseconds * 1.0e3) << " M indices/s" << std::endl;
+    };
+    std::cout << "Vertex fetch benchmark (" << NUM_SLICES << " slices, " << NUM_INSTANCES << " instances x " << NUM_DRAWS << " draws):" << std::endl;
+    report("planar", planarCylinder, planarMilliseconds);
+    report("interleaved", interleavedCylinder, interleavedMilliseconds);
+    report("quantized", quantizedCylinder, quantizedMilliseconds);
+    std::cout << "  interleaved is " << std::setprecision(2) << planarMilliseconds / std::max(interleavedMilliseconds, 1.0e-6)
+        << "x the speed of planar, quantized is " << interleavedMilliseconds / std::max(quantizedMilliseconds, 1.0e-6)
+        << "x the speed of interleaved" << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <glad/glad.h>
+
+/**
+ * Compares vertex fetch of the planar and the interleaved vertex layout, and of float and quantized
+ * interleaved vertices. Draws a finely sliced cylinder in each variant many times into a 1x1 viewport,
+ * so that rasterization costs next to nothing, times the draws with GL timer queries and prints
+ * vertex size, GPU time and vertex throughput of each. The quantized cylinder is drawn with the same
+ * program, so its time covers the fetch, not the decoding. Restores the viewport, but leaves the
+ * program and VAO bindings changed. GL thread only.
+ *
+ * @param programID  Program reading position, texture coordinate and normal at the StaticMesh3D attribute indices
+ */
+void benchmarkVertexFetch(GLuint programID);
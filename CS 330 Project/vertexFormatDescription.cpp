@@ -0,0 +1,23 @@
+// Project
+#include "vertexFormatDescription.h"
+
+bool VertexAttributeDescription::operator==(const VertexAttributeDescription& other) const
+{
+    return index == other.index && numComponents == other.numComponents && type == other.type
+        && isNormalized == other.isNormalized && offset == other.offset && stride == other.stride;
+}
+
+bool VertexFormatDescription::operator==(const VertexFormatDescription& other) const
+{
+    return vertexByteSize == other.vertexByteSize && attributes == other.attributes;
+}
+
+void setVertexAttributePointers(const VertexFormatDescription& format)
+{
+    for (const auto& attribute : format.attributes)
+    {
+        glEnableVertexAttribArray(attribute.index);
+        glVertexAttribPointer(attribute.index, attribute.numComponents, attribute.type, attribute.isNormalized,
+            static_cast<GLsizei>(attribute.stride), reinterpret_cast<void*>(attribute.offset));
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+// STL
+#include <vector>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+/**
+ * One vertex attribute as glVertexAttribPointer takes it.
+ */
+struct VertexAttributeDescription
+{
+    GLuint index; // Attribute location
+    GLint numComponents; // Number of components (1 to 4)
+    GLenum type; // Component type (GL_FLOAT, GL_UNSIGNED_SHORT...)
+    GLboolean isNormalized; // Whether integers are mapped to [0, 1] / [-1, 1]
+    size_t offset; // Byte offset of the attribute of the first vertex
+    size_t stride; // Bytes between attributes of consecutive vertices
+
+    bool operator==(const VertexAttributeDescription& other) const;
+};
+
+/**
+ * All vertex attributes of a vertex buffer. Meshes whose descriptions are equal (and whose offsets don't
+ * depend on the vertex count, i.e. interleaved ones) can share one vertex array object.
+ */
+struct VertexFormatDescription
+{
+    std::vector<VertexAttributeDescription> attributes; // Attributes in the order of their locations
+    size_t vertexByteSize = 0; // Size of one vertex in bytes
+
+    bool operator==(const VertexFormatDescription& other) const;
+};
+
+/**
+ * Enables and points all attributes of given format into the buffer bound to GL_ARRAY_BUFFER (recorded in the bound VAO).
+ */
+void setVertexAttributePointers(const VertexFormatDescription& format);
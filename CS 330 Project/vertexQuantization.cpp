@@ -0,0 +1,84 @@
+// STL
+#include <cmath>
+#include <algorithm>
+
+// Project
+#include "vertexQuantization.h"
+
+namespace {
+
+/**
+ * Converts [-1, 1] float to signed normalized integer with given maximum, rounding to nearest.
+ */
+int32_t toSnorm(float value, int32_t maximum)
+{
+    const auto clamped = std::min(std::max(value, -1.0f), 1.0f);
+    return static_cast<int32_t>(std::lround(clamped * maximum));
+}
+
+} // namespace
+
+QuantizationRange computeQuantizationRange(const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    QuantizationRange result;
+    result.origin = minimum;
+    for (auto i = 0; i < 3; i++)
+    {
+        // Flat axis quantizes everything to 0, any scale but 0 keeps the math finite
+        const auto extent = maximum[i] - minimum[i];
+        result.scale[i] = extent > 0.0f ? extent : 1.0f;
+    }
+
+    return result;
+}
+
+uint16_t quantizeUnorm16(float value, float origin, float scale)
+{
+    const auto normalized = std::min(std::max((value - origin) / scale, 0.0f), 1.0f);
+    return static_cast<uint16_t>(std::lround(normalized * 65535.0f));
+}
+
+QuantizedPosition quantizePosition(const glm::vec3& position, const QuantizationRange& range)
+{
+    QuantizedPosition result;
+    result.x = quantizeUnorm16(position.x, range.origin.x, range.scale.x);
+    result.y = quantizeUnorm16(position.y, range.origin.y, range.scale.y);
+    result.z = quantizeUnorm16(position.z, range.origin.z, range.scale.z);
+    result.padding = 0;
+    return result;
+}
+
+uint32_t quantizeTextureCoordinate(const glm::vec2& textureCoordinate, const QuantizationRange& range)
+{
+    const uint32_t u = quantizeUnorm16(textureCoordinate.x, range.origin.x, range.scale.x);
+    const uint32_t v = quantizeUnorm16(textureCoordinate.y, range.origin.y, range.scale.y);
+    return u | (v << 16);
+}
+
+uint32_t encodeOctahedral(const glm::vec3& direction)
+{
+    // Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the diagonals
+    const auto length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    auto x = length > 0.0f ? direction.x / length : 0.0f;
+    auto y = length > 0.0f ? direction.y / length : 0.0f;
+    if (direction.z < 0.0f)
+    {
+        const auto foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const auto foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    const auto packedX = static_cast<uint32_t>(toSnorm(x, 32767)) & 0xFFFF;
+    const auto packedY = static_cast<uint32_t>(toSnorm(y, 32767)) & 0xFFFF;
+    return packedX | (packedY << 16);
+}
+
+uint32_t packTangent(const glm::vec3& tangent, float bitangentSign)
+{
+    const auto x = static_cast<uint32_t>(toSnorm(tangent.x, 511)) & 0x3FF;
+    const auto y = static_cast<uint32_t>(toSnorm(tangent.y, 511)) & 0x3FF;
+    const auto z = static_cast<uint32_t>(toSnorm(tangent.z, 511)) & 0x3FF;
+    const auto w = static_cast<uint32_t>(bitangentSign < 0.0f ? -1 : 1) & 0x3;
+    return x | (y << 10) | (z << 20) | (w << 30);
+}
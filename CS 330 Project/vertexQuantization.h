@@ -0,0 +1,62 @@
+#pragma once
+// STL
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+/**
+ * Maps quantized values back to the original range, value = origin + quantized * scale, where the
+ * quantized value is the [0, 1] float the GL makes of an unsigned normalized integer. The vertex
+ * shader applies it per component (uniforms positionOrigin / positionScale and the like).
+ */
+struct QuantizationRange
+{
+    glm::vec3 origin = glm::vec3(0.0f); // Value of quantized 0
+    glm::vec3 scale = glm::vec3(1.0f); // Value of quantized 1 minus value of quantized 0
+};
+
+/**
+ * Position quantized to 16-bit unsigned normalized components. The fourth component is padding,
+ * so that every attribute starts at a multiple of 4 bytes.
+ */
+struct QuantizedPosition
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+    uint16_t padding;
+};
+
+/**
+ * Computes range covering all values between given minimum and maximum (any axis may be flat).
+ */
+QuantizationRange computeQuantizationRange(const glm::vec3& minimum, const glm::vec3& maximum);
+
+/**
+ * Quantizes value of given range component to 16-bit unsigned normalized integer (nearest, clamped).
+ */
+uint16_t quantizeUnorm16(float value, float origin, float scale);
+
+/**
+ * Quantizes position to 16-bit unsigned normalized components relative to given range.
+ */
+QuantizedPosition quantizePosition(const glm::vec3& position, const QuantizationRange& range);
+
+/**
+ * Quantizes texture coordinate to two 16-bit unsigned normalized components relative to the
+ * x and y of given range (U in the low half).
+ */
+uint32_t quantizeTextureCoordinate(const glm::vec2& textureCoordinate, const QuantizationRange& range);
+
+/**
+ * Encodes unit vector in octahedral mapping as two 16-bit signed normalized components (X in the low half).
+ * Read as 2 x GL_SHORT normalized and decoded by decodeOctahedral in the vertex shader.
+ */
+uint32_t encodeOctahedral(const glm::vec3& direction);
+
+/**
+ * Packs unit tangent to GL_INT_2_10_10_10_REV (X in the lowest 10 bits), with the sign of
+ * the bitangent (relative to cross(normal, tangent)) in the 2-bit W component.
+ */
+uint32_t packTangent(const glm::vec3& tangent, float bitangentSign);
@@ -0,0 +1,85 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "vertexWriter.h"
+
+namespace static_meshes_3D {
+
+VertexWriter::VertexWriter(const StaticMesh3D& mesh, VertexBufferObject& vbo, int numVertices)
+    : VertexWriter(mesh, vbo.addUninitializedData(static_cast<size_t>(mesh.getVertexByteSize()) * numVertices), numVertices) {}
+
+VertexWriter::VertexWriter(const StaticMesh3D& mesh, unsigned char* vertexData, int numVertices)
+    : _numVertices(numVertices)
+    , _vertexFormat(mesh.getVertexFormat())
+    , _positionRange(mesh.getPositionRange())
+    , _textureCoordinateRange(mesh.getTextureCoordinateRange())
+{
+    _positions = createStream(mesh, StaticMesh3D::POSITION_ATTRIBUTE_INDEX, mesh.hasPositions(), vertexData);
+    _textureCoordinates = createStream(mesh, StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX, mesh.hasTextureCoordinates(), vertexData);
+    _normals = createStream(mesh, StaticMesh3D::NORMAL_ATTRIBUTE_INDEX, mesh.hasNormals(), vertexData);
+}
+
+void VertexWriter::addPosition(const glm::vec3& position, int repeat)
+{
+    if (_vertexFormat == VertexFormat::Quantized)
+    {
+        const auto quantizedPosition = quantizePosition(position, _positionRange);
+        write(_positions, quantizedPosition, repeat);
+        return;
+    }
+
+    write(_positions, position, repeat);
+}
+
+void VertexWriter::addTextureCoordinate(const glm::vec2& textureCoordinate, int repeat)
+{
+    if (_vertexFormat == VertexFormat::Quantized)
+    {
+        const auto quantizedTextureCoordinate = quantizeTextureCoordinate(textureCoordinate, _textureCoordinateRange);
+        write(_textureCoordinates, quantizedTextureCoordinate, repeat);
+        return;
+    }
+
+    write(_textureCoordinates, textureCoordinate, repeat);
+}
+
+void VertexWriter::addNormal(const glm::vec3& normal, int repeat)
+{
+    if (_vertexFormat == VertexFormat::Quantized)
+    {
+        const auto encodedNormal = encodeOctahedral(normal);
+        write(_normals, encodedNormal, repeat);
+        return;
+    }
+
+    write(_normals, normal, repeat);
+}
+
+VertexWriter::AttributeStream VertexWriter::createStream(const StaticMesh3D& mesh, int attributeIndex, bool isPresent, unsigned char* vertexData) const
+{
+    AttributeStream result;
+    if (isPresent && vertexData != nullptr)
+    {
+        const auto placement = mesh.getAttributePlacement(attributeIndex, _numVertices);
+        result.data = vertexData + placement.offset;
+        result.stride = placement.stride;
+    }
+
+    return result;
+}
+
+template<typename T>
+void VertexWriter::write(AttributeStream& stream, const T& value, int repeat) const
+{
+    const auto count = std::min(repeat, _numVertices - stream.numWritten);
+    if (stream.data == nullptr || count <= 0) {
+        return;
+    }
+
+    // Planar attributes are contiguous, the span fills repeats of them in bulk
+    StagingSpan<T>(stream.data, _numVertices, stream.stride).fill(stream.numWritten, count, value);
+    stream.numWritten += count;
+}
+
+} // namespace static_meshes_3D
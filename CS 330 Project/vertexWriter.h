@@ -0,0 +1,73 @@
+#pragma once
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "staticMesh3D.h"
+#include "vertexBufferObject.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Writes vertex attributes of a static mesh into its VBO data, in whichever vertex layout and format the mesh has.
+ * Every attribute is written in vertex order, independently of the others, so generators add all
+ * positions, then all texture coordinates etc. and the writer places them (planar or interleaved)
+ * and quantizes them, if the mesh wants them quantized (its position and texture coordinate bounds must be set by then).
+ * Attributes the mesh does not have are ignored, as are attributes beyond the last vertex.
+ */
+class VertexWriter
+{
+public:
+	/**
+	 * Appends space for given number of vertices to the VBO data. Nothing else may be added
+	 * to the VBO while the writer is in use.
+	 *
+	 * @param mesh         Mesh the vertices belong to (decides present attributes and layout)
+	 * @param vbo          VBO to write the vertices to
+	 * @param numVertices  Number of vertices to write
+	 */
+	VertexWriter(const StaticMesh3D& mesh, VertexBufferObject& vbo, int numVertices);
+
+	/**
+	 * Writes vertices to given memory (e.g. a mapped range of a shared buffer), with room for numVertices vertices.
+	 */
+	VertexWriter(const StaticMesh3D& mesh, unsigned char* vertexData, int numVertices);
+
+	/**
+	 * Writes position of the next vertex (or of the next few vertices, if repeated).
+	 */
+	void addPosition(const glm::vec3& position, int repeat = 1);
+
+	/**
+	 * Writes texture coordinate of the next vertex (or of the next few vertices, if repeated).
+	 */
+	void addTextureCoordinate(const glm::vec2& textureCoordinate, int repeat = 1);
+
+	/**
+	 * Writes normal of the next vertex (or of the next few vertices, if repeated).
+	 */
+	void addNormal(const glm::vec3& normal, int repeat = 1);
+
+private:
+	struct AttributeStream
+	{
+		unsigned char* data = nullptr; // Where the attribute of the first vertex goes, nullptr if the mesh doesn't have it
+		size_t stride = 0; // Bytes between attributes of consecutive vertices
+		int numWritten = 0; // Number of vertices written so far
+	};
+
+	int _numVertices; // Number of vertices to write
+	VertexFormat _vertexFormat; // Format of the written attributes
+	QuantizationRange _positionRange; // Range of quantized positions
+	QuantizationRange _textureCoordinateRange; // Range of quantized texture coordinates
+	AttributeStream _positions; // Position of every vertex
+	AttributeStream _textureCoordinates; // Texture coordinate of every vertex
+	AttributeStream _normals; // Normal of every vertex
+
+	AttributeStream createStream(const StaticMesh3D& mesh, int attributeIndex, bool isPresent, unsigned char* vertexData) const;
+
+	template<typename T>
+	void write(AttributeStream& stream, const T& value, int repeat) const;
+};
+
+} // namespace static_meshes_3D